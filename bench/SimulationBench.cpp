@@ -0,0 +1,320 @@
+#include "Action.h"
+#include "Auxiliary.h"
+#include "FacilityCatalog.h"
+#include "OutputWriter.h"
+#include "SelectionPolicy.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+using std::vector;
+
+/*
+Times the hot paths of a simulation and prints the results as one JSON document, to be kept
+and compared from release to release:
+- step: plans x ticks per second, for every policy mix (with settlements of every type) and
+  every settlement-type mix (with plans of every policy), and the heap allocations per tick
+- select: selectFacility calls per second, for every policy, against catalogs of every size
+- backup: the latency of backup, restore, and the first step after a restore (which copies
+  whatever it changes), against the number of plans and of facilities they built
+- load: the time to load a config, against its number of lines
+
+Each time is the best of REPETITIONS runs. The makefile builds this with -O2, unlike the
+simulation, so the numbers mean something.
+
+Usage: bench [--threads <count>] [--output <path>]
+*/
+
+Simulation* backup = nullptr;
+
+static size_t heapAllocations = 0;
+
+void* operator new(size_t size) {
+    heapAllocations++;
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+static const int REPETITIONS = 3;
+static const char* CONFIG_PATH = "bin/bench_config.txt";
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The facilities of every config: two of each category, with the costs and scores of the sample config
+static void writeFacilities(std::ofstream &config) {
+    config << "facility hospital 0 5 5 3 1\n";
+    config << "facility school 0 3 4 1 2\n";
+    config << "facility factory 1 4 1 5 1\n";
+    config << "facility bank 1 2 1 3 0\n";
+    config << "facility park 2 2 2 0 4\n";
+    config << "facility solar 2 5 1 2 5\n";
+}
+
+/*
+Writes a config of numOfPlans plans. Plan i gets policies[i % numOfPolicies] and settlement
+type types[i % numOfTypes], in a settlement of its own every 100 plans.
+*/
+static void writeConfig(const string &path, int numOfPlans, const int *policies, int numOfPolicies,
+                        const int *types, int numOfTypes) {
+    std::ofstream config(path);
+    writeFacilities(config);
+    const int numOfSettlements = (numOfPlans + 99) / 100;
+    for (int i = 0; i < numOfSettlements; i++) {
+        config << "settlement S" << i << ' ' << types[i % numOfTypes] << '\n';
+    }
+    for (int i = 0; i < numOfPlans; i++) {
+        config << "plan S" << i / 100 << ' ' << SelectionPolicy::getPolicyName(policies[i % numOfPolicies]) << '\n';
+    }
+    if (!config) {
+        throw std::runtime_error(string("Cannot write ") + path);
+    }
+}
+
+// A config of numOfLines lines: a tenth settlements, a tenth facilities, the rest plans
+static void writeConfigOfLines(const string &path, int numOfLines) {
+    std::ofstream config(path);
+    const int numOfSettlements = numOfLines / 10;
+    const int numOfFacilities = numOfLines / 10;
+    for (int i = 0; i < numOfSettlements; i++) {
+        config << "settlement S" << i << ' ' << i % 3 << '\n';
+    }
+    for (int i = 0; i < numOfFacilities; i++) {
+        config << "facility F" << i << ' ' << i % 3 << ' ' << 1 + i % 5 << ' ' << i % 4 << ' ' << i % 5 << ' ' << i % 3 << '\n';
+    }
+    for (int i = numOfSettlements + numOfFacilities; i < numOfLines; i++) {
+        config << "plan S" << i % numOfSettlements << ' ' << SelectionPolicy::getPolicyName(i % SelectionPolicy::NUM_OF_POLICIES) << '\n';
+    }
+    if (!config) {
+        throw std::runtime_error(string("Cannot write ") + path);
+    }
+}
+
+static size_t countFacilities(const Simulation &simulation, int numOfPlans) {
+    size_t facilities = 0;
+    for (int planId = 0; planId < numOfPlans; planId++) {
+        facilities += simulation.getPlan(planId).getFacilities().size();
+    }
+    return facilities;
+}
+
+// The results, one JSON object each
+class Results {
+    public:
+        Results() : objects() {}
+
+        void add(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+            char object[512];
+            va_list arguments;
+            va_start(arguments, format);
+            std::vsnprintf(object, sizeof(object), format, arguments);
+            va_end(arguments);
+            objects.push_back(object);
+        }
+
+        void write(std::ostream &stream, int numOfThreads) const {
+            stream << "{\n  \"threads\": " << numOfThreads << ",\n  \"repetitions\": " << REPETITIONS << ",\n  \"results\": [\n";
+            for (size_t i = 0; i < objects.size(); i++) {
+                stream << "    " << objects[i] << (i + 1 < objects.size() ? ",\n" : "\n");
+            }
+            stream << "  ]\n}\n";
+        }
+
+    private:
+        vector<string> objects;
+};
+
+static void benchStep(Results &results, const char *mix, const char *policiesMix, const char *typesMix,
+                      const int *policies, int numOfPolicies, const int *types, int numOfTypes, int numOfThreads) {
+    const int numOfPlans = 10000;
+    const int numOfTicks = 200;
+    writeConfig(CONFIG_PATH, numOfPlans, policies, numOfPolicies, types, numOfTypes);
+    double best = 0;
+    size_t allocations = 0;
+    for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+        Simulation simulation(CONFIG_PATH, numOfThreads);
+        simulation.open();
+        const size_t allocationsBefore = heapAllocations;
+        const Clock::time_point start = Clock::now();
+        for (int tick = 0; tick < numOfTicks; tick++) {
+            simulation.step();
+        }
+        const double seconds = secondsSince(start);
+        allocations = heapAllocations - allocationsBefore;
+        if (repetition == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    results.add("{\"benchmark\": \"step\", \"mix\": \"%s\", \"policies\": \"%s\", \"settlements\": \"%s\", "
+                "\"plans\": %d, \"ticks\": %d, \"seconds\": %.6f, \"plan_ticks_per_sec\": %.0f, \"allocations_per_tick\": %.1f}",
+                mix, policiesMix, typesMix, numOfPlans, numOfTicks, best,
+                static_cast<double>(numOfPlans) * numOfTicks / best, static_cast<double>(allocations) / numOfTicks);
+}
+
+static void benchSelect(Results &results, int policy, int catalogSize) {
+    FacilityCatalog catalog;
+    catalog.reserve(catalogSize);
+    char name[32];
+    for (int i = 0; i < catalogSize; i++) {
+        std::snprintf(name, sizeof(name), "F%d", i);
+        catalog.add(FacilityType(name, static_cast<FacilityCategory>(i % 3), 1 + i % 5, i % 4, i % 5, i % 3));
+    }
+    const int numOfCalls = 200000;
+    double best = 0;
+    size_t checksum = 0;
+    for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+        std::unique_ptr<SelectionPolicy> selectionPolicy(SelectionPolicy::create(policy));
+        const Clock::time_point start = Clock::now();
+        for (int call = 0; call < numOfCalls; call++) {
+            checksum += selectionPolicy->selectFacility(catalog).getCost();
+        }
+        const double seconds = secondsSince(start);
+        if (repetition == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    results.add("{\"benchmark\": \"select\", \"policy\": \"%s\", \"catalog\": %d, \"calls\": %d, "
+                "\"seconds\": %.6f, \"calls_per_sec\": %.0f, \"checksum\": %zu}",
+                SelectionPolicy::getPolicyName(policy), catalogSize, numOfCalls, best, numOfCalls / best, checksum);
+}
+
+static void benchBackup(Results &results, int numOfPlans, int numOfThreads) {
+    const int policies[] = {0, 1, 2, 3};
+    const int types[] = {0, 1, 2};
+    writeConfig(CONFIG_PATH, numOfPlans, policies, 4, types, 3);
+    Simulation simulation(CONFIG_PATH, numOfThreads);
+    simulation.open();
+    simulation.step(50);
+    const size_t numOfFacilities = countFacilities(simulation, numOfPlans);
+    double backupSeconds = 0;
+    double restoreSeconds = 0;
+    double stepSeconds = 0;
+    for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+        Clock::time_point start = Clock::now();
+        BackupSimulation().act(simulation);
+        const double backupTime = secondsSince(start);
+        simulation.step();
+        start = Clock::now();
+        RestoreSimulation().act(simulation);
+        const double restoreTime = secondsSince(start);
+        start = Clock::now();
+        simulation.step();
+        const double stepTime = secondsSince(start);
+        if (repetition == 0 || backupTime < backupSeconds) {
+            backupSeconds = backupTime;
+        }
+        if (repetition == 0 || restoreTime < restoreSeconds) {
+            restoreSeconds = restoreTime;
+        }
+        if (repetition == 0 || stepTime < stepSeconds) {
+            stepSeconds = stepTime;
+        }
+    }
+    delete backup;
+    backup = nullptr;
+    results.add("{\"benchmark\": \"backup\", \"plans\": %d, \"facilities\": %zu, \"backup_seconds\": %.6f, "
+                "\"restore_seconds\": %.6f, \"step_after_restore_seconds\": %.6f}",
+                numOfPlans, numOfFacilities, backupSeconds, restoreSeconds, stepSeconds);
+}
+
+static void benchLoad(Results &results, int numOfLines) {
+    writeConfigOfLines(CONFIG_PATH, numOfLines);
+    double best = 0;
+    for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+        const Clock::time_point start = Clock::now();
+        Simulation simulation(CONFIG_PATH);
+        const double seconds = secondsSince(start);
+        if (repetition == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    results.add("{\"benchmark\": \"load\", \"lines\": %d, \"seconds\": %.6f, \"lines_per_sec\": %.0f}",
+                numOfLines, best, numOfLines / best);
+}
+
+int main(int argc, char** argv) {
+    int numOfThreads = 1;
+    string outputPath;
+    bool validArguments = true;
+    for (int i = 1; i < argc && validArguments; i++) {
+        string argument = argv[i];
+        if (argument == "--threads" && i + 1 < argc) {
+            i++;
+            Argument count = {argv[i], strlen(argv[i])};
+            validArguments = Auxiliary::parseInt(count, numOfThreads);
+        } else if (argument == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            validArguments = false;
+        }
+    }
+    if (!validArguments) {
+        std::cout << "usage: bench [--threads <count>] [--output <path>]" << std::endl;
+        return 0;
+    }
+
+    // What the simulations print would break the JSON
+    output.setDescriptor(OutputWriter::DISCARD);
+    Results results;
+    try {
+        const int allPolicies[] = {0, 1, 2, 3};
+        const int allTypes[] = {0, 1, 2};
+        for (int policy = 0; policy < SelectionPolicy::NUM_OF_POLICIES; policy++) {
+            benchStep(results, "policy", SelectionPolicy::getPolicyName(policy), "all", &policy, 1, allTypes, 3, numOfThreads);
+        }
+        const char* typeNames[] = {"village", "city", "metropolis"};
+        for (int type = 0; type < 3; type++) {
+            benchStep(results, "settlement", "all", typeNames[type], allPolicies, 4, &type, 1, numOfThreads);
+        }
+        benchStep(results, "all", "all", "all", allPolicies, 4, allTypes, 3, numOfThreads);
+
+        for (int policy = 0; policy < SelectionPolicy::NUM_OF_POLICIES; policy++) {
+            for (int catalogSize = 6; catalogSize <= 6144; catalogSize *= 4) {
+                benchSelect(results, policy, catalogSize);
+            }
+        }
+        for (int numOfPlans = 1000; numOfPlans <= 100000; numOfPlans *= 10) {
+            benchBackup(results, numOfPlans, numOfThreads);
+        }
+        for (int numOfLines = 1000; numOfLines <= 1000000; numOfLines *= 10) {
+            benchLoad(results, numOfLines);
+        }
+    } catch (const std::runtime_error &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (outputPath.empty()) {
+        results.write(std::cout, numOfThreads);
+        return 0;
+    }
+    std::ofstream file(outputPath);
+    results.write(file, numOfThreads);
+    if (!file) {
+        std::cerr << "Error: Cannot write " << outputPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include "ActionLog.h"
 #include "Simulation.h"
 extern Simulation* backup;
 enum class SettlementType;
@@ -16,14 +17,17 @@ class BaseAction{
         ActionStatus getStatus() const;
         string getStringStatus() const;
         virtual void act(Simulation& simulation)=0;
-        virtual const string toString() const=0;
+        virtual const string toString() const;
+        virtual ActionLog::Record toRecord(ActionLog &log) const=0;  // What log keeps of it, with its strings interned there
         virtual BaseAction* clone() const = 0;
         virtual ~BaseAction() = default;
+        static BaseAction *fromRecord(const ActionLog::Record &record, const ActionLog &log);
 
     protected:
         void complete();
         void error(string errorMsg);
         const string &getErrorMsg() const;
+        ActionLog::Record makeRecord(ActionLog::Kind kind) const;
 
     private:
         string errorMsg;
@@ -35,7 +39,7 @@ class SimulateStep : public BaseAction {
     public:
         SimulateStep(const int numOfSteps);
         void act(Simulation &simulation) override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
         SimulateStep *clone() const override;
     private:
         const int numOfSteps;
@@ -45,7 +49,7 @@ class AddPlan : public BaseAction {
     public:
         AddPlan(const string &settlementName, const string &selectionPolicy);
         void act(Simulation &simulation) override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
         AddPlan *clone() const override;
     private:
         const string settlementName;
@@ -58,7 +62,7 @@ class AddSettlement : public BaseAction {
         AddSettlement(const string &settlementName,SettlementType settlementType);
         void act(Simulation &simulation) override;
         AddSettlement *clone() const override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
     private:
         const string settlementName;
         const SettlementType settlementType;
@@ -71,7 +75,7 @@ class AddFacility : public BaseAction {
         AddFacility(const string &facilityName, const FacilityCategory facilityCategory, const int price, const int lifeQualityScore, const int economyScore, const int environmentScore);
         void act(Simulation &simulation) override;
         AddFacility *clone() const override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
     private:
         const string facilityName;
         const FacilityCategory facilityCategory;
@@ -87,7 +91,7 @@ class PrintPlanStatus: public BaseAction {
         PrintPlanStatus(int planId);
         void act(Simulation &simulation) override;
         PrintPlanStatus *clone() const override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
     private:
         const int planId;
 };
@@ -98,7 +102,7 @@ class ChangePlanPolicy : public BaseAction {
         ChangePlanPolicy(const int planId, const string &newPolicy);
         void act(Simulation &simulation) override;
         ChangePlanPolicy *clone() const override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
     private:
         const int planId;
         const string newPolicy;
@@ -110,7 +114,7 @@ class PrintActionsLog : public BaseAction {
         PrintActionsLog();
         void act(Simulation &simulation) override;
         PrintActionsLog *clone() const override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
     private:
 };
 
@@ -119,25 +123,72 @@ class Close : public BaseAction {
         Close();
         void act(Simulation &simulation) override;
         Close *clone() const override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
     private:
 };
 
 class BackupSimulation : public BaseAction {
     public:
         BackupSimulation();
+        BackupSimulation(const string &backupName);//named checkpoint, see Checkpoints
         void act(Simulation &simulation) override;
         BackupSimulation *clone() const override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
     private:
+        const string backupName;
 };
 
 
 class RestoreSimulation : public BaseAction {
     public:
         RestoreSimulation();
+        RestoreSimulation(const string &backupName);
         void act(Simulation &simulation) override;
         RestoreSimulation *clone() const override;
-        const string toString() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
     private:
-};
\ No newline at end of file
+        const string backupName;
+};
+
+
+class PrintBackups : public BaseAction {
+    public:
+        PrintBackups();
+        void act(Simulation &simulation) override;
+        PrintBackups *clone() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
+    private:
+};
+
+
+class DropBackup : public BaseAction {
+    public:
+        DropBackup(const string &backupName);
+        void act(Simulation &simulation) override;
+        DropBackup *clone() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
+    private:
+        const string backupName;
+};
+
+class SaveSimulation : public BaseAction {
+    public:
+        SaveSimulation(const string &path);//binary snapshot, see Snapshot
+        void act(Simulation &simulation) override;
+        SaveSimulation *clone() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
+    private:
+        const string path;
+};
+
+
+class LoadSimulation : public BaseAction {
+    public:
+        LoadSimulation(const string &path);
+        void act(Simulation &simulation) override;
+        LoadSimulation *clone() const override;
+        ActionLog::Record toRecord(ActionLog &log) const override;
+    private:
+        const string path;
+};
+
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "CopyOnWrite.h"
+#include "SharedChunkList.h"
+using std::string;
+
+/*
+The log of the actions a simulation ran. An action is kept as a fixed size record, its
+kind and arguments, with strings (names, policies, paths) interned once in the log and
+referred to by id; the log line is formatted only when printed.
+Records and strings live in SharedChunkLists, so appending is O(1) and a backup shares the
+log with the simulation it was copied from until either appends. The index of the strings
+is copied only when one of them interns a string the other does not have.
+*/
+class ActionLog {
+    public:
+        static const int MAX_ARGS = 6;  // A facility: its name, category, price and three scores
+        static const int NUM_OF_KINDS = 14;
+
+        enum class Kind : uint8_t {
+            STEP, PLAN, SETTLEMENT, FACILITY, PLAN_STATUS, CHANGE_POLICY, LOG, CLOSE,
+            BACKUP, RESTORE, BACKUPS, DROP_BACKUP, SAVE, LOAD
+        };
+
+        struct Record {
+            Kind kind;
+            bool completed;
+            int32_t args[MAX_ARGS];  // Numbers, and string ids from intern() of a log; -1 for no string
+        };
+
+        ActionLog();
+
+        //Methods
+        void append(const Record &record);
+        size_t size() const;
+        const Record &operator[](size_t index) const;
+        void format(const Record &record, string &line) const;
+        static int getNumOfArgs(Kind kind);
+        static bool isStringArg(Kind kind, int arg);
+        int32_t intern(const string &text);
+        const string &getString(int32_t id) const;
+        size_t getNumOfStrings() const;
+
+    private:
+        SharedChunkList<Record> records;
+        SharedChunkList<string> strings;
+        CopyOnWrite<std::unordered_map<string, int32_t>> ids;  // of the interned strings; lines are not
+};
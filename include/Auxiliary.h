@@ -1,10 +1,26 @@
 #pragma once
+#include <cstddef>
 #include <iostream>
 #include <vector>
-#include <sstream>
 #include <string>
 
+// A whitespace separated field of a line: where it starts in the line and its length.
+// It does not own its characters, so it is valid only while the line is unchanged.
+struct Argument {
+    const char *data;
+    size_t length;
+
+    bool operator==(const char *text) const;
+    bool operator!=(const char *text) const;
+    std::string str() const;
+};
+
 class Auxiliary{
     public:
-        static std::vector<std::string> parseArguments(const std::string& line);
+        static void splitArguments(const std::string &line, std::vector<Argument> &arguments);
+        static void splitArguments(const char *begin, const char *end, std::vector<Argument> &arguments);
+        static bool parseInt(const Argument &argument, int &value);
+        static bool parseInts(const std::vector<Argument> &arguments, size_t first, size_t count, int *values);
+        static bool isSettlementType(int value);
+        static bool isFacilityCategory(int value);
 };
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "FacilityCatalog.h"
+#include "SelectionPolicy.h"
+using std::vector;
+
+/*
+Makes the picks of many BalancedSelection policies together. Picks are made in rounds,
+one per policy and round, so each policy still sees the totals of its own previous pick;
+the queries of a round go through the catalog in one BalancedKernel::argminBatch call.
+The picks and the policies end up exactly as if every policy had selected on its own.
+*/
+class BalancedBatch {
+    public:
+        BalancedBatch();
+
+        //Methods
+        void clear();
+        bool empty() const;
+        void add(BalancedSelection &policy, int *selected, int numOfSlots);
+        void select(const FacilityCatalog &facilitiesOptions);
+
+    private:
+        vector<BalancedSelection*> policies;
+        vector<int*> outputs; // where the catalog indices of each policy's picks are written
+        vector<int> numOfSlots;
+        vector<size_t> pending; // policies that still need a pick in the current round
+        vector<int> lifeQualityOffsets;
+        vector<int> economyOffsets;
+        vector<int> environmentOffsets;
+        vector<size_t> picks;
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+
+/*
+The search of BalancedSelection: the index of the first facility whose scores, added to the
+given offsets, have the smallest distance between the highest and the lowest of the three.
+The scores come as separate arrays (see FacilityCatalog). The AVX2 or SSE4.1 version is
+picked when the CPU supports it, with a portable loop otherwise; all give the same index.
+argminBatch answers many offsets at once, walking the catalog in tiles that stay in cache
+while every query is run over them.
+*/
+class BalancedKernel {
+    public:
+        static const size_t TILE_SIZE = 1024; // facilities per tile, 12KB of scores
+        static size_t argmin(const int *lifeQualityScores, const int *economyScores, const int *environmentScores, size_t size, int lifeQualityOffset, int economyOffset, int environmentOffset);
+        static size_t scalarArgmin(const int *lifeQualityScores, const int *economyScores, const int *environmentScores, size_t size, int lifeQualityOffset, int economyOffset, int environmentOffset);
+        static void argminBatch(const int *lifeQualityScores, const int *economyScores, const int *environmentScores, size_t size, const int *lifeQualityOffsets, const int *economyOffsets, const int *environmentOffsets, size_t numOfQueries, size_t *indices);
+        static const char* getName();
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Simulation.h"
+using std::string;
+using std::vector;
+
+/*
+Named backups of the simulation. A checkpoint is a copy of the simulation, so it shares
+everything that did not change since its parent (the checkpoint the simulation was last
+saved to or restored from) and only owns the delta: changed plans, their new facilities
+and the log tail. Restoring is a copy back, and dropping a checkpoint frees only what no
+other checkpoint or the simulation still shares.
+*/
+class Checkpoints {
+    public:
+        Checkpoints();
+        Checkpoints(const Checkpoints&) = delete;
+        Checkpoints& operator=(const Checkpoints&) = delete;
+        ~Checkpoints();
+
+        //Methods
+        void save(const string &name, const Simulation &simulation);
+        bool restore(const string &name, Simulation &simulation);
+        bool drop(const string &name);
+        void saveBackup();
+        void restoreBackup();
+        void forgetCurrent();
+        void print() const;
+        bool empty() const;
+
+    private:
+        friend class Journal;  // saves and loads them with its checkpoints
+        struct Checkpoint {
+            Checkpoint(const string &name, const string &parent, Simulation *simulation);
+            Checkpoint(const Checkpoint&) = default;
+            Checkpoint& operator=(const Checkpoint&) = default;
+            string name;
+            string parent;  // empty for a checkpoint of a simulation that was never saved
+            Simulation *simulation;
+        };
+        int find(const string &name) const;
+
+        vector<Checkpoint> checkpoints;  // in the order they were saved
+        string current;  // the parent of the next checkpoint
+        string backupParent;  // what current was when the unnamed backup was taken
+};
+
+extern Checkpoints checkpoints;
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+/*
+The allocator SharedChunkList allocates its chunks with (and their shared counts, in the
+same block). Blocks of a chunk type are all of one size, so a freed one goes on a free list
+of the thread that frees it and is handed out again by the next allocation there, up to
+MAX_FREE of them per type; a thread's free lists are released in bulk when it ends.
+A step frees about as many chunks as it allocates (the completion events of each tick), so
+those no longer reach the heap. A chunk may be freed on another thread than its own.
+*/
+template <typename T>
+class ChunkPool {
+    public:
+        typedef T value_type;
+        static const size_t MAX_FREE = 256;
+
+        ChunkPool() {}
+        template <typename U>
+        ChunkPool(const ChunkPool<U>&) {}
+
+        //Methods
+        T *allocate(size_t n) {
+            if (n == 1 && freeList.head != nullptr) {
+                FreeBlock *block = freeList.head;
+                freeList.head = block->next;
+                freeList.size--;
+                return reinterpret_cast<T*>(block);
+            }
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T *memory, size_t n) {
+            if (n != 1 || freeList.closed || freeList.size == MAX_FREE) {
+                ::operator delete(memory);
+                return;
+            }
+            releaser.keep();
+            FreeBlock *block = reinterpret_cast<FreeBlock*>(memory);
+            block->next = freeList.head;
+            freeList.head = block;
+            freeList.size++;
+        }
+
+    private:
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
+        // Trivial, so it can still be read after the releaser ran, by the destructors of statics
+        struct FreeList {
+            FreeBlock *head;
+            size_t size;
+            bool closed;
+        };
+
+        // Releases the free list when the thread ends; made by the first block kept
+        class Releaser {
+            public:
+                Releaser() {}
+                ~Releaser() {
+                    while (freeList.head != nullptr) {
+                        FreeBlock *block = freeList.head;
+                        freeList.head = block->next;
+                        ::operator delete(block);
+                    }
+                    freeList.size = 0;
+                    freeList.closed = true;
+                }
+                void keep() {}
+        };
+
+        static thread_local FreeList freeList;
+        static thread_local Releaser releaser;
+};
+
+template <typename T>
+thread_local typename ChunkPool<T>::FreeList ChunkPool<T>::freeList = {nullptr, 0, false};
+
+template <typename T>
+thread_local typename ChunkPool<T>::Releaser ChunkPool<T>::releaser;
+
+template <typename T, typename U>
+bool operator==(const ChunkPool<T>&, const ChunkPool<U>&) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const ChunkPool<T>&, const ChunkPool<U>&) {
+    return false;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Simulation.h"
+using std::string;
+
+/*
+A config file compiled to binary (see tools/CompileConfig.cpp), so a large config starts
+without tokenizing a line or calling stoi per field. Simulation(configFilePath) loads an
+image in place of the text when the file starts with MAGIC.
+
+Layout: a Header, then a string table, the settlements, the facility catalog as one array
+per field, and the plans, each at the offset the header gives. Plans get the IDs 0..n-1
+in order, as they do when the text config is read.
+*/
+class ConfigImage {
+    public:
+        static const uint32_t VERSION = 1;
+
+        //Methods
+        static void compile(const Simulation &simulation, const string &path);
+        static bool isImage(const string &path);
+        static void load(const string &path, Simulation &simulation);
+
+    private:
+        struct StringRef {
+            uint64_t offset;
+            uint32_t length;
+            uint32_t padding;
+        };
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t padding;
+            uint64_t stringsSize, stringsOffset;
+            uint64_t numOfSettlements, settlementsOffset;
+            uint64_t numOfFacilityTypes;
+            uint64_t facilityNamesOffset, categoriesOffset, pricesOffset;
+            uint64_t lifeQualityScoresOffset, economyScoresOffset, environmentScoresOffset;
+            uint64_t numOfPlans, plansOffset;
+        };
+
+        struct SettlementRecord {
+            StringRef name;
+            int32_t type;
+            int32_t padding;
+        };
+
+        struct PlanRecord {
+            int32_t settlement;  // index into the settlements
+            int32_t policy;  // id, see SelectionPolicy::findPolicy
+        };
+
+        static const char MAGIC[8];
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Simulation.h"
+using std::string;
+using std::vector;
+
+/*
+Reads a text config into a simulation. The file is mapped and cut into chunks at line
+ends; the chunks are parsed on the simulation's workers, each into its own list of
+entries, and the entries are then added to the simulation in file order on one thread.
+Parsing is the slow part, and adding in order keeps everything that depends on order
+(duplicate settlements and facilities, a plan's settlement, which error is reported)
+exactly as when the file is read line by line.
+*/
+class ConfigLoader {
+    public:
+        //Methods
+        static void load(const string &path, Simulation &simulation);
+
+    private:
+        static const size_t PARALLEL_MIN_BYTES = 1 << 20;  // Smaller files are parsed as one chunk
+
+        enum class EntryType {
+            SETTLEMENT, FACILITY, PLAN
+        };
+
+        // A settlement, facility or plan line of the config, parsed
+        struct Entry {
+            Entry() : type(EntryType::SETTLEMENT), name(), policy(), values() {}
+            EntryType type;
+            string name;  // of the settlement or facility, or the plan's settlement
+            string policy;  // of a plan
+            int values[5];  // settlement type, or facility category, price and scores
+        };
+
+        // The lines [begin, end) of the file, and what parsing them produced
+        struct Chunk {
+            Chunk() : begin(0), end(0), entries(), numOfLines(0), invalidLine() {}
+            size_t begin;
+            size_t end;
+            vector<Entry> entries;
+            int numOfLines;  // Lines parsed, up to the first malformed one
+            string invalidLine;  // The first malformed line, empty if there is none
+        };
+
+        static void parse(const char *data, Chunk &chunk);
+        static void add(const Entry &entry, Simulation &simulation);
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include "Facility.h"
+#include "Settlement.h"
+
+// The facilities a plan is building, stored as parallel arrays instead of Facility objects.
+// Each slot keeps the simulation tick in which it becomes operational rather than a
+// countdown, so a plan only has to be visited on the ticks where something finishes.
+// No settlement builds more than Settlement::MAX_CONSTRUCTION_LIMIT facilities at once,
+// so the arrays live inline in the plan and never touch the heap.
+class ConstructionQueue {
+    public:
+        ConstructionQueue();
+
+        //Methods
+        int size() const;
+        int getTypeId(int slot) const;
+        int getFinishTick(int slot) const;
+        int getTimeLeft(int slot, const int tick) const;
+        int nextFinishTick(const int tick) const;
+        void push(const FacilityType &type, const int typeId, const int tick);
+        void resume(const FacilityType &type, const int typeId, const int finishTick);
+        void postpone(const int tick, const int ticks);
+        int complete(const int tick, int *completedTypeIds, int &lifeQualityScore, int &economyScore, int &environmentScore);
+
+    private:
+        static const int CAPACITY = Settlement::MAX_CONSTRUCTION_LIMIT;
+        int count;
+        int finishTicks[CAPACITY];
+        int typeIds[CAPACITY];
+        int lifeQualityScores[CAPACITY];
+        int economyScores[CAPACITY];
+        int environmentScores[CAPACITY];
+};
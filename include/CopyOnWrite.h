@@ -0,0 +1,43 @@
+#pragma once
+#include <memory>
+
+/*
+A value whose copies share one instance until one of them changes it. Copying is O(1):
+get() reads the shared instance, and edit() returns a private one, copying the shared
+instance first if another copy still refers to it.
+edit() may run on several threads for different values, but not while a copy sharing
+the same instance is being made or destroyed.
+*/
+template <typename T>
+class CopyOnWrite {
+    public:
+        CopyOnWrite() : value(std::make_shared<T>()) {}
+        explicit CopyOnWrite(T *value) : value(value) {}
+
+        //Methods
+        const T &get() const {
+            return *value;
+        }
+
+        const T *operator->() const {
+            return value.get();
+        }
+
+        T &edit() {
+            if (value.use_count() > 1) {
+                value = std::make_shared<T>(*value);
+            }
+            return *value;
+        }
+
+        bool isShared() const {
+            return value.use_count() > 1;
+        }
+
+        bool sharesWith(const CopyOnWrite &other) const {
+            return value == other.value;
+        }
+
+    private:
+        std::shared_ptr<T> value;
+};
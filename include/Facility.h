@@ -43,14 +43,24 @@ class FacilityType {
 
 
 
-class Facility: public FacilityType {
+class Settlement;
+
+// A facility built by a plan. It only refers to its catalog entry (by index into the
+// facility options) and to its settlement, so building one never copies strings.
+class Facility {
 
     public:
-        //Constructor   
-        Facility(const string &name, const string &settlementName, const FacilityCategory category, const int price, const int lifeQuality_score, const int economy_score, const int environment_score);
-        Facility(const FacilityType &type, const string &settlementName);
-        ~Facility()=default;    
+        //Constructor
+        Facility(const FacilityType &type, const int typeId, const Settlement &settlement);
+        Facility(const int typeId, const Settlement &settlement);//already operational
+        Facility(const Facility &other, const Settlement &otherSettlement);//copy into another settlement
+        Facility(const Facility &other) = default;
+        Facility& operator=(const Facility &other) = default;
+        ~Facility()=default;
         //Methods
+        int getTypeId() const;
+        const FacilityType &getType(const vector<FacilityType> &facilityOptions) const;
+        const Settlement &getSettlement() const;
         const string &getSettlementName() const;
         const int getTimeLeft() const;
         FacilityStatus step();
@@ -59,7 +69,8 @@ class Facility: public FacilityType {
         const string toString() const;
 
     private:
-        const string settlementName;
-        FacilityStatus status;
+        const Settlement *settlement;
+        int typeId;
         int timeLeft;
+        FacilityStatus status;
 };
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Facility.h"
+using std::string;
+using std::vector;
+
+// The facility types plans can build, in the order they were added.
+// Next to the types it keeps the indices of each category and an index by name, both
+// updated as types are added, so policies and lookups never scan the whole catalog.
+// The scores are also kept as contiguous arrays for the searches that do scan it.
+class FacilityCatalog {
+    public:
+        FacilityCatalog();
+
+        //Methods
+        bool add(const FacilityType &facility);
+        bool contains(const string &facilityName) const;
+        void clear();
+        void reserve(size_t numOfFacilities);
+        size_t size() const;
+        bool empty() const;
+        const FacilityType &operator[](size_t index) const;
+        const vector<FacilityType> &getFacilities() const;
+        const vector<int> &getCategoryIndices(FacilityCategory category) const;
+        const int *getLifeQualityScores() const;
+        const int *getEconomyScores() const;
+        const int *getEnvironmentScores() const;
+
+    private:
+        static const int NUM_OF_CATEGORIES = 3;
+        vector<FacilityType> facilities;
+        vector<int> categoryIndices[NUM_OF_CATEGORIES];
+        std::unordered_map<string, int> indexByName;
+        vector<int> lifeQualityScores;
+        vector<int> economyScores;
+        vector<int> environmentScores;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ActionLog.h"
+#include "Simulation.h"
+using std::string;
+
+/*
+A write-ahead journal of the actions a simulation runs, to rebuild the simulation after a
+crash. The file starts with a Header naming a checkpoint, a snapshot of the simulation
+saved as <journal>.<generation>, and holds an entry for every action run since then.
+
+An entry is written before its action runs, with a single write() and no fsync: a process
+crash loses nothing. A background thread fsyncs the file every SYNC_INTERVAL_MS when
+something was written, so the commands of an interval share one fsync and none of them
+waits for the disk; a machine crash loses at most the last interval.
+
+Every CHECKPOINT_ENTRIES entries the simulation is saved as the next generation and the
+journal replaced, by a rename, with an empty one naming it, so a crash at any point leaves
+a journal and a checkpoint that match. The backups of the session are part of a checkpoint:
+the backup as <checkpoint>.backup and each named checkpoint as <checkpoint>.checkpoint<i>,
+listed with their names in <checkpoint>.backups. Each of these and the simulation, in that
+order, also lists the plans it shares with one listed before it, and those are shared again
+when they are recovered. Facilities and the log are not, so recovered backups may take more
+memory than they did.
+
+Replaying must not touch other files than the journal's. A save changes nothing the journal
+rebuilds, so its entry is written after it runs, with its outcome, and replaying it only logs
+it. A load is followed by a checkpoint, so only a crash in between replays it from its file.
+*/
+class Journal {
+    public:
+        // Where replaying a journal stopped
+        struct Replayed {
+            Replayed() : generation(0), numOfEntries(0), end(0) {}
+            uint64_t generation;  // of the checkpoint it started from
+            uint64_t numOfEntries;  // entries run
+            size_t end;  // offset past the last entry run
+        };
+
+        Journal();
+        Journal(const Journal&) = delete;
+        Journal& operator=(const Journal&) = delete;
+        ~Journal();
+
+        //Methods
+        void create(const string &path, const Simulation &simulation);
+        Simulation recover(const string &path, const int numOfThreads);
+        static Simulation replay(const string &path, const int numOfThreads, Replayed &replayed);
+        static bool isJournal(const string &path);
+        bool isOpen() const;
+        void beforeAction(const ActionLog::Record &record, const ActionLog &log);
+        void afterAction(const ActionLog::Record &record, const Simulation &simulation);
+        void close();
+
+    private:
+        static const char MAGIC[8];
+        static const uint32_t VERSION = 1;
+        static const int SYNC_INTERVAL_MS = 50;
+        static const uint64_t CHECKPOINT_ENTRIES = 1 << 16;
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t padding;
+            uint64_t generation;  // of the checkpoint the entries follow
+        };
+
+        // Precedes the payload of an entry: its kind, a byte (with FAILED set for a save that
+        // failed), then each of its args as an int32, or a string as a uint32 length (NO_STRING
+        // for none) and its bytes
+        struct EntryHeader {
+            uint32_t size;  // of the payload
+            uint32_t checksum;  // of the payload, to stop at an entry the crash cut short
+        };
+        static const uint32_t NO_STRING = 0xFFFFFFFF;
+        static const unsigned char FAILED = 0x80;
+
+        static string getCheckpointPath(const string &path, uint64_t generation);
+        void append(const ActionLog::Record &record, const ActionLog &log);
+        void checkpoint(const Simulation &simulation);
+        void saveCheckpoint(const Simulation &simulation, uint64_t generation);
+        void removeCheckpoint(uint64_t generation);
+        static Simulation loadCheckpoint(const string &checkpointPath);
+        static string getSharedPlans(const vector<const Simulation*> &simulations, size_t index, std::unordered_map<const Plan*, size_t> &owners);
+        static void sharePlans(Simulation &simulation, const Simulation &owner, std::istream &ranges);
+        void replace(uint64_t generation);
+        void syncLoop();
+        static bool decode(const char *payload, uint32_t size, ActionLog::Record &record, ActionLog &strings);
+
+        string path;
+        uint64_t generation;
+        uint64_t numOfEntries;  // since the checkpoint
+        int descriptor;  // -1 when no journal is open
+        string entry;  // the entry being written, reused from one to the next
+        std::atomic<bool> dirty;  // written since the last fsync
+        bool stopping;
+        std::mutex mutex;  // held by the sync thread while it syncs, and to replace descriptor
+        std::condition_variable wake;
+        std::thread syncer;
+};
+
+extern Journal journal;
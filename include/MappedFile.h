@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+using std::string;
+
+// A read only mapping of a whole file (a config, a config image or a snapshot), unmapped
+// when it goes out of scope. kind names the file in the errors it throws.
+class MappedFile {
+    public:
+        MappedFile(const string &path, const string &kind);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        //Methods
+        const char *getData() const;  // nullptr for an empty file
+        size_t getSize() const;
+        // numOfRecords records of type T at offset, checked to be inside the file.
+        // nullptr for no records, which may sit past the end of the file.
+        template <typename T>
+        const T *records(uint64_t offset, uint64_t numOfRecords) const {
+            if (offset % alignof(T) != 0 || (numOfRecords != 0 && (offset > size || numOfRecords > (size - offset) / sizeof(T)))) {
+                throw std::runtime_error("Invalid " + kind);
+            }
+            return numOfRecords == 0 ? nullptr : reinterpret_cast<const T*>(data + offset);
+        }
+
+    private:
+        const string kind;
+        const char *data;
+        size_t size;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+/*
+Collects what the simulation prints and writes it to a file descriptor in large blocks.
+Printing through std::cout with std::endl flushed on every line, a system call per line of
+a log or plan status. The buffer is written when it fills, on flush() and on destruction;
+the interactive loop flushes after every command, a script only when it ends.
+*/
+class OutputWriter {
+    public:
+        static const int DISCARD = -1;  // A descriptor that drops everything written to it
+
+        explicit OutputWriter(int descriptor);
+        OutputWriter(const OutputWriter&) = delete;
+        OutputWriter& operator=(const OutputWriter&) = delete;
+        ~OutputWriter();
+
+        //Methods
+        OutputWriter &operator<<(const string &text);
+        OutputWriter &operator<<(const char *text);
+        OutputWriter &operator<<(char character) {
+            if (used == CAPACITY) {
+                flush();
+            }
+            buffer[used++] = character;
+            return *this;
+        }
+        OutputWriter &operator<<(int value);
+        OutputWriter &operator<<(size_t value);
+        void write(const char *data, size_t length) {
+            if (length > CAPACITY - used) {
+                writeLarge(data, length);
+                return;
+            }
+            std::memcpy(buffer.data() + used, data, length);
+            used += length;
+        }
+        void flush();
+        int setDescriptor(int descriptor);
+
+    private:
+        static const size_t CAPACITY = 1 << 20;
+        void writeLarge(const char *data, size_t length);
+        void writeAll(const char *data, size_t length);
+
+        vector<char> buffer;
+        size_t used;
+        int descriptor;
+};
+
+extern OutputWriter output;  // Standard output
+extern OutputWriter errors;  // Standard error, flushed after every error
@@ -1,8 +1,11 @@
 #pragma once
 #include <vector>
 #include "Facility.h"
+#include "FacilityCatalog.h"
+#include "ConstructionQueue.h"
 #include "Settlement.h"
 #include "SelectionPolicy.h"
+#include "RunList.h"
 using std::vector;
 
 enum class PlanStatus {
@@ -10,10 +13,14 @@ enum class PlanStatus {
     BUSY,
 };
 
+/*
+The catalog is passed to the methods that pick facilities instead of being kept, so a plan
+can be shared by simulations whose catalogs have since grown apart (see CopyOnWrite).
+Copies share their operational facilities.
+*/
 class Plan {
     public:
-        Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const vector<FacilityType> &facilityOptions);
-        Plan(const Plan& other, const Settlement &otherSettlement, const vector<FacilityType> otherFacilityOptions);//another copy constructor
+        Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy);
 
         // Rule of 5 without Copy Assignment Operator,Move Constructor and Move Assignment Operator, as there is a const member variable
         Plan(const Plan& other); // Copy constructor
@@ -31,21 +38,30 @@ class Plan {
         const int getEnvironmentScore() const;
         const string getStatus() const;
         const SelectionPolicy* getSelectionPolicy() const;
+        SelectionPolicy* getSelectionPolicy();
         void setSelectionPolicy(SelectionPolicy *selectionPolicy);
-        void step();
+        int getFreeSlots() const;
+        int startConstruction(const int tick, const FacilityCatalog &facilityOptions);
+        int startConstruction(const int tick, const FacilityCatalog &facilityOptions, const int *selected);
+        bool completeConstruction(const int tick);
+        void fastForward(const int tick, const int numOfSteps, const FacilityCatalog &facilityOptions);
+        bool isAvailable() const;
         void printStatus();
-        const vector<Facility*> &getFacilities() const;
-        const vector<Facility*> &getUnderConstruction() const;
-        void addFacility(Facility* facility);
+        const RunList<Facility> &getFacilities() const;
+        const ConstructionQueue &getUnderConstruction() const;
+        void addFacility(const Facility &facility);
+        void resumeConstruction(const FacilityType &type, const int typeId, const int finishTick);
+        void restore(const bool available, const int lifeQualityScore, const int economyScore, const int environmentScore);
         const string toString() const;
 
     private:
+        void getCycleState(const int tick, vector<int> &state) const;
+
         int plan_id;
         const Settlement &settlement;
         SelectionPolicy *selectionPolicy;
         PlanStatus status;
-        vector<Facility*> facilities;
-        vector<Facility*> underConstruction;
-        const vector<FacilityType> &facilityOptions;
+        RunList<Facility> facilities;
+        ConstructionQueue underConstruction;
         int life_quality_score, economy_score, environment_score;
 };
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "Simulation.h"
+using std::string;
+
+/*
+Runs a recorded session again, as fast as the actions allow: a text recording (the commands
+of the session, one per line, as typed or as a script) on a simulation loaded from a config
+or a snapshot, or a journal from its checkpoint. Text is read from a mapped file and split in
+place, entries are decoded in place, and nothing waits on a terminal; what the actions print
+goes wherever output is sent, to be discarded or written to a file in large blocks.
+*/
+class Replay {
+    public:
+        // What was replayed, and how long it took
+        struct Result {
+            Result() : numOfActions(0), seconds(0) {}
+            size_t numOfActions;
+            double seconds;
+        };
+
+        //Methods
+        static void replayText(const string &recordingPath, Simulation &simulation, Result &result);
+        static Simulation replayJournal(const string &journalPath, const int numOfThreads, Result &result);
+        static int verify(const string &recordedOutputPath, const Simulation &simulation);
+
+    private:
+        // The final scores of a plan, as the recorded output last printed them
+        struct Scores {
+            Scores() : recorded(false), lifeQuality(0), economy(0), environment(0) {}
+            bool recorded;
+            int lifeQuality;
+            int economy;
+            int environment;
+        };
+};
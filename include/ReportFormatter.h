@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include "OutputWriter.h"
+using std::string;
+
+enum class ReportFormat {
+    TEXT, CSV, JSON_LINES
+};
+
+/*
+Writes reports (plan status, the close summary) as records of named fields, straight
+into an OutputWriter: numbers are formatted in place and nothing is allocated.
+TEXT is the "Name: value" line per field the simulation always printed.
+CSV writes a record as one row of values, in field order. A list is one quoted value, its
+records separated by ';' and their values by ':' (a ':', ';' or '\\' in a value is escaped
+with a '\\'), so every row of a report has the columns of its header. A row is held back
+until it ends, and preceded by a header line of its column names whenever they differ
+from the last header (so the first plan status and the close summary each get one).
+JSON_LINES writes a record as one JSON object per line, with a list as an array of objects.
+*/
+class ReportFormatter {
+    public:
+        explicit ReportFormatter(OutputWriter &writer);
+
+        //Methods
+        void setFormat(ReportFormat format);
+        ReportFormat getFormat() const;
+        static bool parseFormat(const string &name, ReportFormat &format);
+        void beginRecord();
+        void endRecord();
+        void beginList(const char *name);
+        void endList();
+        void field(const char *name, int value);
+        void field(const char *name, const char *value);
+        void field(const char *name, const string &value);
+
+    private:
+        static const int MAX_DEPTH = 4;  // A record, a list in it and that list's records
+        void push();
+        void pop();
+        void separate(const char *name);
+        void writeString(const char *value, size_t length);
+        void putQuoted(const char *value, size_t length);
+        void put(char character);
+        void put(const char *text, size_t length);
+        void put(int value);
+        void addColumn(const char *name);
+
+        OutputWriter &writer;
+        ReportFormat format;
+        int depth;
+        bool firstField[MAX_DEPTH];  // Per open record or list, whether nothing was written in it yet
+        string row;  // CSV: the row being written, held back until its header is known
+        string list;  // CSV: the list being written, a value of that row once it ends
+        string columns;  // CSV: the column names of that row
+        string header;  // CSV: the column names last written as a header
+};
+
+extern ReportFormatter report;  // Reports printed to the standard output
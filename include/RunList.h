@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "SharedChunkList.h"
+using std::vector;
+
+/*
+A SharedChunkList that can also repeat its tail: repeatTail(first, times) appends times
+copies of the items from first on without copying any, as a counted run that reading
+resolves to the items it repeats. Repeating is O(1), and a list holds a run per repeat, so
+copies share the items and only copy the runs.
+*/
+template <typename T>
+class RunList {
+    public:
+        RunList() : items(), runs(), count(0) {}
+
+        //Methods
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        const T &operator[](size_t index) const {
+            typename vector<Run>::const_iterator run = std::upper_bound(runs.begin(), runs.end(), index,
+                [](size_t value, const Run &other) { return value < other.end; });
+            if (run != runs.end() && index >= run->begin) {
+                return items[run->first + (index - run->begin) % run->length];
+            }
+            return items[index - (run == runs.begin() ? 0 : (run - 1)->shift)];
+        }
+
+        void push_back(const T &item) {
+            items.push_back(item);
+            count++;
+        }
+
+        // Appends times copies of the items from first on, which must have been pushed since the last repeat
+        void repeatTail(size_t first, size_t times) {
+            const size_t length = count - first;
+            if (length == 0 || times == 0) {
+                return;
+            }
+            const size_t storedFirst = first - (runs.empty() ? 0 : runs.back().shift);
+            Run run = {count, count + length * times, storedFirst, length, 0};
+            run.shift = run.end - items.size();
+            runs.push_back(run);
+            count = run.end;
+        }
+
+        void clear() {
+            items.clear();
+            runs.clear();
+            count = 0;
+        }
+
+    private:
+        // Items [begin, end) repeat the stored items [first, first + length); the ones after
+        // it, up to the next run, are the stored items shift places before
+        struct Run {
+            size_t begin, end;
+            size_t first, length;
+            size_t shift;
+        };
+
+        SharedChunkList<T> items;
+        vector<Run> runs;
+        size_t count;
+};
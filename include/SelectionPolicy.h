@@ -2,24 +2,50 @@
 #include <vector>
 #include <string>
 #include "Facility.h"
+#include "FacilityCatalog.h"
 
 using std::vector;
 using std::string;
 
 class SelectionPolicy {
     public:
-        virtual const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) = 0;
+        virtual const FacilityType& selectFacility(const FacilityCatalog& facilitiesOptions) = 0;
+        // Makes numOfSlots selections at once and writes their catalog indices to selected
+        virtual void selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots);
         virtual const string toString() const = 0;
         virtual SelectionPolicy* clone() const = 0;
         virtual ~SelectionPolicy() = default;
+
+        // Fast forward support: the cycle state decides all future selections, and the
+        // offset is a part of the state that can grow without changing them
+        virtual void getCycleState(vector<int> &state) const = 0;
+        virtual long long getCycleOffset() const;
+        virtual void addCycleOffset(long long offset);
+
+        // Snapshot support: everything a policy remembers, in at most STATE_SIZE values
+        static const int STATE_SIZE = 3;
+        virtual void getState(int *state) const = 0;
+        virtual void setState(const int *state) = 0;
+
+        // The policies a plan can have, by the names commands and configs give them (toString()).
+        // A policy's id is the index snapshots and config images store for it.
+        static const int NUM_OF_POLICIES = 4;
+        static int findPolicy(const char *name, size_t length);  // -1 if there is no such policy
+        static int findPolicy(const string &name);
+        static const char *getPolicyName(int policy);
+        static SelectionPolicy *create(int policy);
 };
 
 class NaiveSelection : public SelectionPolicy {
     public:
         NaiveSelection();
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        const FacilityType& selectFacility(const FacilityCatalog& facilitiesOptions) override;
+        void selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots) override;
         const string toString() const override;
         NaiveSelection* clone() const override;
+        void getCycleState(vector<int> &state) const override;
+        void getState(int *state) const override;
+        void setState(const int *state) override;
         ~NaiveSelection() override = default;
     private:
         size_t lastSelectedIndex;
@@ -28,9 +54,19 @@ class NaiveSelection : public SelectionPolicy {
 class BalancedSelection : public SelectionPolicy {
     public:
         BalancedSelection(int LifeQualityScore, int EconomyScore, int EnvironmentScore);
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        const FacilityType& selectFacility(const FacilityCatalog& facilitiesOptions) override;
+        void selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots) override;
         const string toString() const override;
         BalancedSelection* clone() const override;
+        void getCycleState(vector<int> &state) const override;
+        void getState(int *state) const override;
+        void setState(const int *state) override;
+        long long getCycleOffset() const override;
+        void addCycleOffset(long long offset) override;
+        int getLifeQualityScore() const;
+        int getEconomyScore() const;
+        int getEnvironmentScore() const;
+        void addSelection(const FacilityCatalog& facilitiesOptions, size_t index);
         ~BalancedSelection() override = default;
     private:
         int LifeQualityScore;
@@ -41,21 +77,29 @@ class BalancedSelection : public SelectionPolicy {
 class EconomySelection : public SelectionPolicy {
     public:
         EconomySelection();
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        const FacilityType& selectFacility(const FacilityCatalog& facilitiesOptions) override;
+        void selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots) override;
         const string toString() const override;
         EconomySelection* clone() const override;
+        void getCycleState(vector<int> &state) const override;
+        void getState(int *state) const override;
+        void setState(const int *state) override;
         ~EconomySelection() override = default;
     private:
-        size_t lastSelectedIndex;
+        size_t lastSelectedIndex; // position in the catalog's ECONOMY indices
 };
 
 class SustainabilitySelection : public SelectionPolicy {
     public:
         SustainabilitySelection();
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        const FacilityType& selectFacility(const FacilityCatalog& facilitiesOptions) override;
+        void selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots) override;
         const string toString() const override;
         SustainabilitySelection* clone() const override;
+        void getCycleState(vector<int> &state) const override;
+        void getState(int *state) const override;
+        void setState(const int *state) override;
         ~SustainabilitySelection() override = default;
     private:
-        size_t lastSelectedIndex;
+        size_t lastSelectedIndex; // position in the catalog's ENVIRONMENT indices
 };
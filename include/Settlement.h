@@ -21,6 +21,7 @@ class Settlement {
         const string &getName() const;
         SettlementType getType() const;
         const int constructionLimit() const;
+        static const int MAX_CONSTRUCTION_LIMIT = 3; // limit of the largest settlement type
         const string toString() const;
 
     private:
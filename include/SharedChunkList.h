@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "ChunkPool.h"
+using std::vector;
+
+/*
+A list whose copies share their items. Items are stored in chunks of CHUNK_SIZE that never
+move, each a single allocation from a ChunkPool, so copying a list only copies its chunk
+pointers, and freed chunks are reused.
+Appending writes into the last chunk in place unless another copy has already appended
+past this list's end there, and edit() changes an item in place unless another copy shares
+its chunk: in both cases only that chunk is copied.
+A list may be changed while its copies are read, but not while they are changed. Items of
+chunks no copy shares may be edited on several threads.
+*/
+template <typename T>
+class SharedChunkList {
+    public:
+        static const size_t CHUNK_SIZE = 64;
+
+        SharedChunkList() : chunks(), count(0) {}
+
+        //Methods
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        const T &operator[](size_t index) const {
+            return chunks[index / CHUNK_SIZE]->at(index % CHUNK_SIZE);
+        }
+
+        T &edit(size_t index) {
+            std::shared_ptr<Chunk> &chunk = chunks[index / CHUNK_SIZE];
+            if (chunk.use_count() > 1) {
+                const size_t first = index - index % CHUNK_SIZE;
+                chunk = std::allocate_shared<Chunk>(ChunkPool<Chunk>(), *chunk, count - first < CHUNK_SIZE ? count - first : CHUNK_SIZE);
+            }
+            return chunk->at(index % CHUNK_SIZE);
+        }
+
+        size_t getChunkCount() const {
+            return chunks.size();
+        }
+
+        void push_back(const T &item) {
+            const size_t used = count % CHUNK_SIZE;
+            if (used == 0) {
+                chunks.push_back(std::allocate_shared<Chunk>(ChunkPool<Chunk>()));
+            } else if (chunks.back()->size() != used) {
+                // The items past ours belong to another copy, or to nobody any more
+                if (chunks.back().use_count() == 1) {
+                    chunks.back()->truncate(used);
+                } else {
+                    chunks.back() = std::allocate_shared<Chunk>(ChunkPool<Chunk>(), *chunks.back(), used);
+                }
+            }
+            chunks.back()->push_back(item);
+            count++;
+        }
+
+        void clear() {
+            chunks.clear();
+            count = 0;
+        }
+
+    private:
+        class Chunk {
+            public:
+                Chunk() : items(), used(0) {}
+                Chunk(const Chunk &other, size_t count) : items(), used(0) {
+                    for (size_t i = 0; i < count; i++) {
+                        push_back(other.at(i));
+                    }
+                }
+                Chunk(const Chunk&) = delete;
+                Chunk& operator=(const Chunk&) = delete;
+                ~Chunk() {
+                    truncate(0);
+                }
+
+                size_t size() const {
+                    return used;
+                }
+
+                const T &at(size_t index) const {
+                    return *reinterpret_cast<const T*>(&items[index]);
+                }
+
+                T &at(size_t index) {
+                    return *reinterpret_cast<T*>(&items[index]);
+                }
+
+                void push_back(const T &item) {
+                    new (&items[used]) T(item);
+                    used++;
+                }
+
+                void truncate(size_t count) {
+                    while (used > count) {
+                        used--;
+                        reinterpret_cast<T*>(&items[used])->~T();
+                    }
+                }
+
+            private:
+                typename std::aligned_storage<sizeof(T), alignof(T)>::type items[CHUNK_SIZE];
+                size_t used;
+        };
+
+        vector<std::shared_ptr<Chunk>> chunks;
+        size_t count;
+};
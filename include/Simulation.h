@@ -1,18 +1,60 @@
 #pragma once
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
+#include "ActionLog.h"
+#include "Auxiliary.h"
+#include "BalancedBatch.h"
+#include "CopyOnWrite.h"
 #include "Facility.h"
+#include "FacilityCatalog.h"
 #include "Plan.h"
 #include "Settlement.h"
+#include "SharedChunkList.h"
+#include "WorkerPool.h"
 using std::string;
 using std::vector;
 
 class BaseAction;
 class SelectionPolicy;
 
+typedef std::pair<int, int> CompletionEvent;  // (tick a facility finishes in, index of its plan)
+// The indices of the plans with a facility finishing, by tick. Facilities take a few ticks
+// to build, so there are few ticks, and a list shares its chunks with the backups.
+typedef std::map<int, SharedChunkList<int>> CompletionEvents;
+
+// A range of the plans visited in a step, with what stepping them produced
+struct StepChunk {
+    StepChunk() : begin(0), end(0), events(), readyPlans(), balancedBatch(), selected() {}
+    size_t begin;
+    size_t end;
+    vector<CompletionEvent> events;
+    vector<int> readyPlans;
+    BalancedBatch balancedBatch;
+    vector<int> selected;  // picks of the balanced plans, MAX_CONSTRUCTION_LIMIT per plan of the chunk
+};
+
+// What a simulation changed since another one it was copied from
+struct SimulationDelta {
+    SimulationDelta() : changedPlans(0), newFacilities(0), newActions(0) {}
+    size_t changedPlans;  // plans that are not shared, new ones included
+    size_t newFacilities;
+    size_t newActions;
+};
+
+/*
+Copies of a simulation share their state: every part is a CopyOnWrite or SharedChunkList,
+so copying (a backup) copies at most chunk pointers, and only the parts changed afterwards
+get copied, chunk by chunk and plan by plan. The worker threads are not copied.
+*/
 class Simulation {
 public:
     Simulation(const string& configFilePath);
+    Simulation(const string& configFilePath, const int numOfThreads);
 
     // Rule of 5
     Simulation(const Simulation& other);  // Copy Constructor
@@ -23,6 +65,7 @@ public:
 
     // Methods
     void start();
+    size_t runScript(const string& scriptPath);
     void addPlan(const Settlement& settlement, SelectionPolicy* selectionPolicy);
     void addAction(BaseAction* action);
     bool addSettlement(Settlement* settlement);
@@ -30,21 +73,52 @@ public:
     bool isSettlementExists(const string& settlementName);
     bool isFacilityExists(const string& facilityName);  
     const vector<Settlement*> getSettlements();  
-    vector<BaseAction*> getActionsLog();  
+    const ActionLog &getActionsLog() const;
     Settlement& getSettlement(const string& settlementName);
-    bool planExists(const int planID);
-    Plan& getPlan(const int planID);
+    bool planExists(const int planID) const;
+    const Plan& getPlan(const int planID) const;
+    Plan& getPlan(const int planID);  // for changes only: copies the plan if a backup shares it
     void step();
+    void step(const int numOfSteps);
+    void setNumOfThreads(const int numOfThreads);
     void close();
     void open();
+    const FacilityCatalog &getFacilityOptions() const;
+    int getCurrentTick() const;
+    SimulationDelta diff(const Simulation *parent) const;
 
 private:
+    friend class ConfigImage;
+    friend class ConfigLoader;
+    friend class Journal;
+    friend class Snapshot;
+    Simulation();  // empty, for Snapshot::load
+
+    static const int FAST_FORWARD_MIN_STEPS = 256;  // Shorter runs are stepped tick by tick
+    static const size_t PARALLEL_MIN_PLANS = 512;  // Steps visiting fewer plans stay on one thread
+    static const int CHUNKS_PER_WORKER = 4;
+    void runCommand(const char *begin, const char *end, vector<Argument> &arguments);
+    void rebuildEvents();
+    void editTouchedPlans();
+    int partitionTouchedPlans();
+    void runChunks(const int numOfChunks, const WorkerPool::Task &task);
+    void selectBalanced(StepChunk &chunk);
+    void stepPlans(StepChunk &chunk, const int tick);
+
     bool isRunning;
     int planCounter;  // For assigning unique plan IDs
-    vector<BaseAction*> actionsLog;
-    vector<Plan> plans;
-    vector<Settlement*> settlements;
-    vector<FacilityType> facilitiesOptions;
+    int currentTick;  // Number of steps simulated so far
+    CopyOnWrite<ActionLog> actionsLog;
+    CopyOnWrite<vector<std::shared_ptr<Settlement>>> settlements;  // Declared before plans, which refer to them
+    CopyOnWrite<std::unordered_map<string, Settlement*>> settlementsByName;  // Index of settlements, owned by settlements
+    SharedChunkList<CopyOnWrite<Plan>> plans;
+    SharedChunkList<int> planIndexById;  // Plan IDs are dense, so this maps an ID to its index in plans
+    CopyOnWrite<FacilityCatalog> facilitiesOptions;
+    CopyOnWrite<vector<int>> readyPlans;  // Indices of the plans that are available at the start of the next step
+    CopyOnWrite<CompletionEvents> completionEvents;
+    vector<int> touchedPlans;  // Plans visited by the current step, sorted by index
+    vector<StepChunk> stepChunks;
+    WorkerPool *workerPool;  // nullptr when plans are stepped on one thread
 };
 
 
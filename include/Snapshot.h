@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Simulation.h"
+using std::string;
+
+/*
+The whole state of a simulation in a versioned binary file: settlements, the facility
+catalog, plans with their policy state, scores, facilities and construction queue, and
+the action log as its records. Step events are not stored, they are rebuilt from the plans.
+
+Layout: a Header, then arrays of fixed size records at the offsets it gives, and a string
+table that the records refer to by offset and length. Numbers are stored in host byte
+order; a file written on a machine of the other order fails the magic check.
+Loading maps the file and reads the records in place, without parsing.
+*/
+class Snapshot {
+    public:
+        static const uint32_t VERSION = 2;
+
+        //Methods
+        static void save(const Simulation &simulation, const string &path);
+        static Simulation load(const string &path);
+        static Simulation load(const string &path, std::unordered_map<string, std::shared_ptr<Settlement>> &settlementPool);
+
+    private:
+        struct StringRef {
+            uint64_t offset;
+            uint32_t length;
+            uint32_t padding;
+        };
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t isRunning;
+            int32_t currentTick;
+            int32_t planCounter;
+            uint64_t numOfSettlements, settlementsOffset;
+            uint64_t numOfFacilityTypes, facilityTypesOffset;
+            uint64_t numOfPlans, plansOffset;
+            uint64_t numOfFacilities, facilitiesOffset;  // type ids of the operational facilities of all plans
+            uint64_t numOfActions, actionsOffset;
+            uint64_t numOfLogStrings, logStringsOffset;  // the strings of the action log, by id
+            uint64_t stringsSize, stringsOffset;
+        };
+
+        struct SettlementRecord {
+            StringRef name;
+            int32_t type;
+            int32_t padding;
+        };
+
+        struct FacilityTypeRecord {
+            StringRef name;
+            int32_t category, price, lifeQualityScore, economyScore, environmentScore;
+            int32_t padding;
+        };
+
+        struct PlanRecord {
+            int32_t id;
+            int32_t settlement;  // index into the settlements
+            int32_t available;
+            int32_t policy;  // id, see SelectionPolicy::findPolicy
+            int32_t policyState[SelectionPolicy::STATE_SIZE];
+            int32_t lifeQualityScore, economyScore, environmentScore;
+            int32_t numOfUnderConstruction;
+            int32_t finishTicks[Settlement::MAX_CONSTRUCTION_LIMIT];
+            int32_t typeIds[Settlement::MAX_CONSTRUCTION_LIMIT];
+            int32_t padding;
+            uint64_t firstFacility, numOfFacilities;
+        };
+
+        struct ActionRecord {
+            int32_t kind;
+            int32_t completed;
+            int32_t args[ActionLog::MAX_ARGS];  // as in ActionLog::Record, string ids index the log strings
+        };
+
+        static StringRef addString(string &strings, const string &value);
+        static string readString(const char *strings, uint64_t stringsSize, const StringRef &ref);
+
+        static const char MAGIC[8];
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+using std::vector;
+
+// Threads that stay alive for the whole simulation and run batches of tasks.
+// The thread calling run() takes part as worker 0, so a pool of size 1 has no threads.
+class WorkerPool {
+    public:
+        typedef std::function<void(int task, int worker)> Task;
+
+        explicit WorkerPool(int numOfWorkers);
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+        ~WorkerPool();
+
+        //Methods
+        int size() const;
+        void run(int numOfTasks, const Task &task);
+
+    private:
+        void work(int worker);
+        void runTasks(int worker);
+
+        vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        std::condition_variable finished;
+        const Task *task;
+        int numOfTasks;
+        std::atomic<int> nextTask;
+        int busyWorkers;
+        unsigned long generation;
+        bool stopping;
+        std::exception_ptr failure;
+};
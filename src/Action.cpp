@@ -1,6 +1,10 @@
 #include "Action.h"
+#include "Checkpoints.h"
+#include "OutputWriter.h"
+#include "ReportFormatter.h"
 #include "Simulation.h"
-#include <iostream>
+#include "Snapshot.h"
+#include <stdexcept>
 
 // BaseAction implementation
 BaseAction::BaseAction() : errorMsg(""),status(ActionStatus::COMPLETED) {}
@@ -24,13 +28,71 @@ void BaseAction::complete() {
 void BaseAction::error(string errorMsg) {
     this->errorMsg = errorMsg;
     status = ActionStatus::ERROR;
-    std::cerr << "Error: " << errorMsg << std::endl;
+    output.flush();  // So the error comes after everything printed before it
+    errors << "Error: " << errorMsg << '\n';
+    errors.flush();
 }
 
 const string &BaseAction::getErrorMsg() const {
     return errorMsg;
 }
 
+// The log line of the action, formatted from its record in a log of its own
+const string BaseAction::toString() const {
+    ActionLog log;
+    string line;
+    log.format(toRecord(log), line);
+    return line;
+}
+
+// A new action that does what the action a record of log was made of did, to run it again
+BaseAction *BaseAction::fromRecord(const ActionLog::Record &record, const ActionLog &log) {
+    const int32_t *args = record.args;
+    switch (record.kind) {
+        case ActionLog::Kind::STEP:
+            return new SimulateStep(args[0]);
+        case ActionLog::Kind::PLAN:
+            return new AddPlan(log.getString(args[0]), log.getString(args[1]));
+        case ActionLog::Kind::SETTLEMENT:
+            return new AddSettlement(log.getString(args[0]), static_cast<SettlementType>(args[1]));
+        case ActionLog::Kind::FACILITY:
+            return new AddFacility(log.getString(args[0]), static_cast<FacilityCategory>(args[1]), args[2], args[3], args[4], args[5]);
+        case ActionLog::Kind::PLAN_STATUS:
+            return new PrintPlanStatus(args[0]);
+        case ActionLog::Kind::CHANGE_POLICY:
+            return new ChangePlanPolicy(args[0], log.getString(args[1]));
+        case ActionLog::Kind::LOG:
+            return new PrintActionsLog();
+        case ActionLog::Kind::CLOSE:
+            return new Close();
+        case ActionLog::Kind::BACKUP:
+            return args[0] == -1 ? new BackupSimulation() : new BackupSimulation(log.getString(args[0]));
+        case ActionLog::Kind::RESTORE:
+            return args[0] == -1 ? new RestoreSimulation() : new RestoreSimulation(log.getString(args[0]));
+        case ActionLog::Kind::BACKUPS:
+            return new PrintBackups();
+        case ActionLog::Kind::DROP_BACKUP:
+            return new DropBackup(log.getString(args[0]));
+        case ActionLog::Kind::SAVE:
+            return new SaveSimulation(log.getString(args[0]));
+        case ActionLog::Kind::LOAD:
+            return new LoadSimulation(log.getString(args[0]));
+        default:
+            throw std::runtime_error("Invalid action record");
+    }
+}
+
+// A record of the given kind with the action's status and no arguments yet
+ActionLog::Record BaseAction::makeRecord(ActionLog::Kind kind) const {
+    ActionLog::Record record;
+    record.kind = kind;
+    record.completed = status == ActionStatus::COMPLETED;
+    for (int i = 0; i < ActionLog::MAX_ARGS; i++) {
+        record.args[i] = 0;
+    }
+    return record;
+}
+
 
 
 
@@ -38,15 +100,14 @@ const string &BaseAction::getErrorMsg() const {
 SimulateStep::SimulateStep(const int numOfSteps) : numOfSteps(numOfSteps) {}
 
 void SimulateStep::act(Simulation &simulation) {
-    for (int i = 0; i < numOfSteps; i++) {
-        simulation.step();
-    }
+    simulation.step(numOfSteps);
     complete();
-    simulation.getActionsLog().push_back(this);
 }
 
-const string SimulateStep::toString() const {
-    return "step "+ std::to_string(numOfSteps)+ getStringStatus();
+ActionLog::Record SimulateStep::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::STEP);
+    record.args[0] = numOfSteps;
+    return record;
 }
 
 SimulateStep *SimulateStep::clone() const {
@@ -64,32 +125,23 @@ AddPlan::AddPlan(const string &settlementName, const string &selectionPolicy)
 void AddPlan::act(Simulation &simulation) {
     if (!simulation.isSettlementExists(settlementName)) {
         this->error("Cannot create this plan");        
-        simulation.getActionsLog().push_back(this);
         return;
     }
-    Settlement& settlement = simulation.getSettlement(settlementName);  
-    
-    if (selectionPolicy == "bal") {
-        simulation.addPlan(settlement,new BalancedSelection(0, 0, 0)); 
-        complete(); 
-    } else if (selectionPolicy == "eco") {
-
-        simulation.addPlan(settlement,new EconomySelection()); 
-        complete(); 
-    } else if (selectionPolicy == "nve") {
-        simulation.addPlan(settlement, new NaiveSelection()); 
-        complete(); 
-    } else if (selectionPolicy == "env") {
-        simulation.addPlan(settlement, new SustainabilitySelection()); 
-        complete(); 
-    }else{
+    Settlement& settlement = simulation.getSettlement(settlementName);
+    const int policy = SelectionPolicy::findPolicy(selectionPolicy);
+    if (policy == -1) {
         this->error("Cannot create this plan");
+        return;
     }
-    simulation.getActionsLog().push_back(this);
+    simulation.addPlan(settlement, SelectionPolicy::create(policy));
+    complete();
 }
 
-const string AddPlan::toString() const {
-    return "plan " + settlementName + " " + selectionPolicy+getStringStatus();
+ActionLog::Record AddPlan::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::PLAN);
+    record.args[0] = log.intern(settlementName);
+    record.args[1] = log.intern(selectionPolicy);
+    return record;
 }
 
 AddPlan *AddPlan::clone() const {
@@ -104,16 +156,20 @@ AddSettlement::AddSettlement(const string &settlementName, SettlementType settle
     : settlementName(settlementName), settlementType(settlementType) {}
 
 void AddSettlement::act(Simulation &simulation) {
-    if (simulation.addSettlement(new Settlement(settlementName, settlementType))){
+    Settlement *settlement = new Settlement(settlementName, settlementType);
+    if (simulation.addSettlement(settlement)){
         complete();
     }else{
+        delete settlement;
         this->error("Settlement already exists");
     } 
-    simulation.getActionsLog().push_back(this);
 }
 
-const string AddSettlement::toString() const {
-    return "settlement " + settlementName+ " "+ std::to_string(static_cast<int>(settlementType)) + getStringStatus();
+ActionLog::Record AddSettlement::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::SETTLEMENT);
+    record.args[0] = log.intern(settlementName);
+    record.args[1] = static_cast<int>(settlementType);
+    return record;
 }
 
 AddSettlement *AddSettlement::clone() const {
@@ -132,11 +188,17 @@ void AddFacility::act(Simulation &simulation) {
     if (simulation.addFacility(newFacility)){
         complete();}
     else{ this->error("Facility already exists");}
-    simulation.getActionsLog().push_back(this);
 }
 
-const string AddFacility::toString() const {
-    return "facility " + facilityName + " " + std::to_string(static_cast<int>(facilityCategory)) + " " + std::to_string(price) + " " + std::to_string(lifeQualityScore) + " " + std::to_string(economyScore) + " " + std::to_string(environmentScore)+getStringStatus();
+ActionLog::Record AddFacility::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::FACILITY);
+    record.args[0] = log.intern(facilityName);
+    record.args[1] = static_cast<int>(facilityCategory);
+    record.args[2] = price;
+    record.args[3] = lifeQualityScore;
+    record.args[4] = economyScore;
+    record.args[5] = environmentScore;
+    return record;
 }
 
 AddFacility *AddFacility::clone() const {
@@ -152,30 +214,43 @@ PrintPlanStatus::PrintPlanStatus(int planId) : planId(planId) {}
 void PrintPlanStatus::act(Simulation &simulation) {
     if (!simulation.planExists(planId)) {
         this->error("Plan doesn't exist");
-        simulation.getActionsLog().push_back(this);
         return;
     }
-    std::cout << "PlanID: " + std::to_string(simulation.getPlan(planId).getId()) << std::endl;
-    std::cout << "SettlementName: " + simulation.getPlan(planId).getSettlement().getName() << std::endl;
-    std::cout << "PlanStatus: " + simulation.getPlan(planId).getStatus() << std::endl;
-    std::cout << "SelectionPolicy: " + simulation.getPlan(planId).getSelectionPolicy()->toString() << std::endl;
-    std::cout << "LifeQualityScore: " + std::to_string(simulation.getPlan(planId).getlifeQualityScore()) << std::endl;
-    std::cout << "EconomyScore: " + std::to_string(simulation.getPlan(planId).getEconomyScore()) << std::endl;
-    std::cout << "EnvironmentScore: " + std::to_string(simulation.getPlan(planId).getEnvironmentScore()) << std::endl;
-    for (Facility* facility : simulation.getPlan(planId).getFacilities()) {
-        std::cout << "FacilityName: " + facility->getName() << std::endl;
-        std::cout << "FacilityStatus: " + facility->toString() << std::endl;
+    // Read through a const Simulation, so a plan a backup shares is not copied
+    const Plan &plan = static_cast<const Simulation&>(simulation).getPlan(planId);
+    const FacilityCatalog &facilityOptions = simulation.getFacilityOptions();
+    report.beginRecord();
+    report.field("PlanID", plan.getId());
+    report.field("SettlementName", plan.getSettlement().getName());
+    report.field("PlanStatus", plan.isAvailable() ? "AVALIABLE" : "BUSY");
+    report.field("SelectionPolicy", plan.getSelectionPolicy()->toString());
+    report.field("LifeQualityScore", plan.getlifeQualityScore());
+    report.field("EconomyScore", plan.getEconomyScore());
+    report.field("EnvironmentScore", plan.getEnvironmentScore());
+    report.beginList("Facilities");
+    const RunList<Facility> &facilities = plan.getFacilities();
+    for (size_t i = 0; i < facilities.size(); i++) {
+        report.beginRecord();
+        report.field("FacilityName", facilityOptions[facilities[i].getTypeId()].getName());
+        report.field("FacilityStatus", facilities[i].getStatus() == FacilityStatus::OPERATIONAL ? "OPERATIONAL" : "UNDER_CONSTRUCTION");
+        report.endRecord();
     }
-    for (Facility* facility : simulation.getPlan(planId).getUnderConstruction()) {
-        std::cout << "FacilityName: " + facility->getName() << std::endl;
-        std::cout << "FacilityStatus: " + facility->toString() << std::endl;
+    const ConstructionQueue &underConstruction = plan.getUnderConstruction();
+    for (int i = 0; i < underConstruction.size(); i++) {
+        report.beginRecord();
+        report.field("FacilityName", facilityOptions[underConstruction.getTypeId(i)].getName());
+        report.field("FacilityStatus", "UNDER_CONSTRUCTION");
+        report.endRecord();
     }
+    report.endList();
+    report.endRecord();
     complete();
-    simulation.getActionsLog().push_back(this);
 }
 
-const string PrintPlanStatus::toString() const {
-    return "planStatus " + std::to_string(planId)+ getStringStatus();
+ActionLog::Record PrintPlanStatus::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::PLAN_STATUS);
+    record.args[0] = planId;
+    return record;
 }
 
 PrintPlanStatus *PrintPlanStatus::clone() const {
@@ -190,42 +265,25 @@ ChangePlanPolicy::ChangePlanPolicy(const int planId, const string &newPolicy)
     : planId(planId), newPolicy(newPolicy) {}
 
 void ChangePlanPolicy::act(Simulation &simulation) {
-    Plan& plan = simulation.getPlan(planId);
-    SelectionPolicy* policy = nullptr;
-    const SelectionPolicy* oldPolicy = plan.getSelectionPolicy();
     if (!simulation.planExists(planId)) {
         this->error("Cannot change selection policy");
-        simulation.getActionsLog().push_back(this);
         return;
     }
-    if (newPolicy == "bal" and oldPolicy->toString() != "BalancedSelection") {
-        policy = new BalancedSelection(0, 0, 0);
-        plan.setSelectionPolicy(policy);
-        complete();
-        simulation.getActionsLog().push_back(this);
-    } else if (newPolicy == "eco" and oldPolicy->toString() != "EconomySelection") {
-        policy = new EconomySelection();
-        plan.setSelectionPolicy(policy);
-        complete();
-        simulation.getActionsLog().push_back(this);
-    } else if (newPolicy == "nve" and oldPolicy->toString() != "NaiveSelection") {
-        policy = new NaiveSelection();
-        plan.setSelectionPolicy(policy);
-        complete();
-        simulation.getActionsLog().push_back(this);
-    } else if (newPolicy == "env" and oldPolicy->toString() != "SustainabilitySelection") {
-        policy = new SustainabilitySelection();
-        plan.setSelectionPolicy(policy);
-        complete();
-        simulation.getActionsLog().push_back(this);
-    }
-    else{
+    Plan& plan = simulation.getPlan(planId);
+    const int policy = SelectionPolicy::findPolicy(newPolicy);
+    if (policy == -1 || policy == SelectionPolicy::findPolicy(plan.getSelectionPolicy()->toString())) {
         this->error("Cannot change selection policy");
-        simulation.getActionsLog().push_back(this);}
+        return;
+    }
+    plan.setSelectionPolicy(SelectionPolicy::create(policy));
+    complete();
 }
 
-const string ChangePlanPolicy::toString() const {
-    return "changePolicy " + std::to_string(planId) + " " + newPolicy+" "+getStringStatus();
+ActionLog::Record ChangePlanPolicy::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::CHANGE_POLICY);
+    record.args[0] = planId;
+    record.args[1] = log.intern(newPolicy);
+    return record;
 }
 
 ChangePlanPolicy *ChangePlanPolicy::clone() const {
@@ -239,15 +297,17 @@ ChangePlanPolicy *ChangePlanPolicy::clone() const {
 PrintActionsLog::PrintActionsLog() {}
 
 void PrintActionsLog::act(Simulation &simulation) {
-    for (BaseAction* action : simulation.getActionsLog()) {
-        std::cout << action->toString() << std::endl;
+    const ActionLog &actionsLog = simulation.getActionsLog();
+    string line;
+    for (size_t i = 0; i < actionsLog.size(); i++) {
+        actionsLog.format(actionsLog[i], line);
+        output << line << '\n';
     }
     complete();
-    simulation.getActionsLog().push_back(this);
 }
 
-const string PrintActionsLog::toString() const {
-    return "log+"+getStringStatus();
+ActionLog::Record PrintActionsLog::toRecord(ActionLog &log) const {
+    return makeRecord(ActionLog::Kind::LOG);
 }
 
 PrintActionsLog *PrintActionsLog::clone() const {
@@ -263,11 +323,10 @@ Close::Close() {}
 void Close::act(Simulation &simulation) {
     simulation.close();
     complete();
-    simulation.getActionsLog().push_back(this);
 }
 
-const string Close::toString() const {
-    return "close"+getStringStatus();
+ActionLog::Record Close::toRecord(ActionLog &log) const {
+    return makeRecord(ActionLog::Kind::CLOSE);
 }
 
 Close *Close::clone() const {
@@ -278,19 +337,28 @@ Close *Close::clone() const {
 
 
 // BackupSimulation implementation - inherit from BaseAction
-BackupSimulation::BackupSimulation() {}
+BackupSimulation::BackupSimulation() : backupName() {}
+
+BackupSimulation::BackupSimulation(const string &backupName) : backupName(backupName) {}
 
 void BackupSimulation::act(Simulation &simulation) {
+    if (!backupName.empty()) {
+        checkpoints.save(backupName, simulation);
+        complete();
+        return;
+    }
     if (backup != nullptr) {
         delete backup;
     }
     backup = new Simulation(simulation);
+    checkpoints.saveBackup();
     complete();
-    simulation.getActionsLog().push_back(this);
 }
 
-const string BackupSimulation::toString() const {
-    return "backup"+getStringStatus();
+ActionLog::Record BackupSimulation::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::BACKUP);
+    record.args[0] = backupName.empty() ? -1 : log.intern(backupName);
+    return record;
 }
 
 BackupSimulation *BackupSimulation::clone() const {
@@ -301,23 +369,129 @@ BackupSimulation *BackupSimulation::clone() const {
 
 
 // RestoreSimulation implementation - inherit from BaseAction
-RestoreSimulation::RestoreSimulation() {}
+RestoreSimulation::RestoreSimulation() : backupName() {}
+
+RestoreSimulation::RestoreSimulation(const string &backupName) : backupName(backupName) {}
 
 void RestoreSimulation::act(Simulation &simulation) {
+    if (!backupName.empty()) {
+        if (checkpoints.restore(backupName, simulation)) {
+            complete();
+        } else {
+            this->error("Backup doesn't exist");
+        }
+        return;
+    }
     if (backup == nullptr) {
         this->error("No backup available");
-        simulation.getActionsLog().push_back(this);
         return;
     }
     simulation = *backup;
+    checkpoints.restoreBackup();
     complete();
-    simulation.getActionsLog().push_back(this);
 }
 
-const string RestoreSimulation::toString() const {
-    return "RestoreSimulation";
+ActionLog::Record RestoreSimulation::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::RESTORE);
+    record.args[0] = backupName.empty() ? -1 : log.intern(backupName);
+    return record;
 }
 
 RestoreSimulation *RestoreSimulation::clone() const {
     return new RestoreSimulation(*this);
-}
\ No newline at end of file
+}
+
+
+
+
+// PrintBackups implementation - inherit from BaseAction
+PrintBackups::PrintBackups() {}
+
+void PrintBackups::act(Simulation &simulation) {
+    checkpoints.print();
+    complete();
+}
+
+ActionLog::Record PrintBackups::toRecord(ActionLog &log) const {
+    return makeRecord(ActionLog::Kind::BACKUPS);
+}
+
+PrintBackups *PrintBackups::clone() const {
+    return new PrintBackups(*this);
+}
+
+
+
+
+// DropBackup implementation - inherit from BaseAction
+DropBackup::DropBackup(const string &backupName) : backupName(backupName) {}
+
+void DropBackup::act(Simulation &simulation) {
+    if (checkpoints.drop(backupName)) {
+        complete();
+    } else {
+        this->error("Backup doesn't exist");
+    }
+}
+
+ActionLog::Record DropBackup::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::DROP_BACKUP);
+    record.args[0] = log.intern(backupName);
+    return record;
+}
+
+DropBackup *DropBackup::clone() const {
+    return new DropBackup(*this);
+}
+
+
+
+
+// SaveSimulation implementation - inherit from BaseAction
+SaveSimulation::SaveSimulation(const string &path) : path(path) {}
+
+void SaveSimulation::act(Simulation &simulation) {
+    try {
+        Snapshot::save(simulation, path);
+        complete();
+    } catch (const std::runtime_error &e) {
+        this->error(e.what());
+    }
+}
+
+ActionLog::Record SaveSimulation::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::SAVE);
+    record.args[0] = log.intern(path);
+    return record;
+}
+
+SaveSimulation *SaveSimulation::clone() const {
+    return new SaveSimulation(*this);
+}
+
+
+
+
+// LoadSimulation implementation - inherit from BaseAction
+LoadSimulation::LoadSimulation(const string &path) : path(path) {}
+
+void LoadSimulation::act(Simulation &simulation) {
+    try {
+        Simulation loaded = Snapshot::load(path);
+        simulation = loaded;  // copy assignment keeps this simulation's workers
+        checkpoints.forgetCurrent();
+        complete();
+    } catch (const std::runtime_error &e) {
+        this->error(e.what());
+    }
+}
+
+ActionLog::Record LoadSimulation::toRecord(ActionLog &log) const {
+    ActionLog::Record record = makeRecord(ActionLog::Kind::LOAD);
+    record.args[0] = log.intern(path);
+    return record;
+}
+
+LoadSimulation *LoadSimulation::clone() const {
+    return new LoadSimulation(*this);
+}
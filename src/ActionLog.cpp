@@ -0,0 +1,156 @@
+#include "ActionLog.h"
+#include <stdexcept>
+
+// The args each kind uses, in the order of Kind, and a bit mask of those that are string ids
+static const int NUM_OF_ARGS[ActionLog::NUM_OF_KINDS] = {1, 2, 2, 6, 1, 2, 0, 0, 1, 1, 0, 1, 1, 1};
+static const int STRING_ARGS[ActionLog::NUM_OF_KINDS] = {0, 3, 1, 1, 0, 2, 0, 0, 1, 1, 0, 1, 1, 1};
+
+static void appendInt(string &line, int32_t value) {
+    char digits[12];
+    int length = 0;
+    int64_t rest = value;
+    if (rest < 0) {
+        line += '-';
+        rest = -rest;
+    }
+    do {
+        digits[length++] = static_cast<char>('0' + rest % 10);
+        rest /= 10;
+    } while (rest != 0);
+    while (length > 0) {
+        line += digits[--length];
+    }
+}
+
+// Constructor
+ActionLog::ActionLog() : records(), strings(), ids() {}
+
+// Methods
+void ActionLog::append(const Record &record) {
+    records.push_back(record);
+}
+
+size_t ActionLog::size() const {
+    return records.size();
+}
+
+const ActionLog::Record &ActionLog::operator[](size_t index) const {
+    return records[index];
+}
+
+/*
+Replaces line with the log line of a record of this log, as the action's toString() gives it:
+its command and arguments, then " COMPLETED" or " ERROR".
+Reusing the same line for every record, printing the log does not allocate once the
+line is long enough for the longest one.
+*/
+void ActionLog::format(const Record &record, string &line) const {
+    const int32_t *args = record.args;
+    line.clear();
+    switch (record.kind) {
+        case Kind::STEP:
+            line += "step ";
+            appendInt(line, args[0]);
+            break;
+        case Kind::PLAN:
+            line += "plan ";
+            line += getString(args[0]);
+            line += ' ';
+            line += getString(args[1]);
+            break;
+        case Kind::SETTLEMENT:
+            line += "settlement ";
+            line += getString(args[0]);
+            line += ' ';
+            appendInt(line, args[1]);
+            break;
+        case Kind::FACILITY:
+            line += "facility ";
+            line += getString(args[0]);
+            for (int i = 1; i < MAX_ARGS; i++) {
+                line += ' ';
+                appendInt(line, args[i]);
+            }
+            break;
+        case Kind::PLAN_STATUS:
+            line += "planStatus ";
+            appendInt(line, args[0]);
+            break;
+        case Kind::CHANGE_POLICY:
+            line += "changePolicy ";
+            appendInt(line, args[0]);
+            line += ' ';
+            line += getString(args[1]);
+            line += ' ';
+            break;
+        case Kind::LOG:
+            line += "log+";
+            break;
+        case Kind::CLOSE:
+            line += "close";
+            break;
+        case Kind::BACKUP:
+            line += "backup";
+            if (args[0] != -1) {
+                line += ' ';
+                line += getString(args[0]);
+            }
+            break;
+        case Kind::RESTORE:
+            if (args[0] == -1) {
+                line += "RestoreSimulation";  // The global restore has no status in the log
+                return;
+            }
+            line += "restore ";
+            line += getString(args[0]);
+            break;
+        case Kind::BACKUPS:
+            line += "backups";
+            break;
+        case Kind::DROP_BACKUP:
+            line += "dropBackup ";
+            line += getString(args[0]);
+            break;
+        case Kind::SAVE:
+            line += "save ";
+            line += getString(args[0]);
+            break;
+        case Kind::LOAD:
+            line += "load ";
+            line += getString(args[0]);
+            break;
+    }
+    line += record.completed ? " COMPLETED" : " ERROR";
+}
+
+int ActionLog::getNumOfArgs(Kind kind) {
+    return NUM_OF_ARGS[static_cast<int>(kind)];
+}
+
+bool ActionLog::isStringArg(Kind kind, int arg) {
+    return (STRING_ARGS[static_cast<int>(kind)] >> arg & 1) != 0;
+}
+
+// The id of text in this log, the same for equal strings
+int32_t ActionLog::intern(const string &text) {
+    std::unordered_map<string, int32_t>::const_iterator found = ids->find(text);
+    if (found != ids->end()) {
+        return found->second;
+    }
+    const int32_t id = static_cast<int32_t>(strings.size());
+    strings.push_back(text);
+    ids.edit().emplace(text, id);
+    return id;
+}
+
+const string &ActionLog::getString(int32_t id) const {
+    if (id < 0 || static_cast<size_t>(id) >= strings.size()) {
+        throw std::runtime_error("Invalid string id");
+    }
+    return strings[id];
+}
+
+// Ids are given in order, so they are 0 to getNumOfStrings() - 1
+size_t ActionLog::getNumOfStrings() const {
+    return strings.size();
+}
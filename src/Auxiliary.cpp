@@ -1,20 +1,100 @@
 #include "Auxiliary.h"
+#include "Facility.h"
+#include "Settlement.h"
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+bool Argument::operator==(const char *text) const {
+    return std::strncmp(data, text, length) == 0 && text[length] == '\0';
+}
+
+bool Argument::operator!=(const char *text) const {
+    return !(*this == text);
+}
+
+std::string Argument::str() const {
+    return std::string(data, length);
+}
+
 /*
-This is a 'static' method that receives a string(line) and returns a vector of the string's arguments.
+This is a 'static' method that receives a string(line) and fills arguments with the line's arguments.
+The arguments point into line instead of being copied, and the vector is cleared and refilled,
+so reading line after line into the same vector does not allocate once it is large enough.
 
 For example:
-parseArguments("settlement KfarSPL 0") will return vector with ["settlement", "KfarSPL", "0"]
+splitArguments("settlement KfarSPL 0", arguments) fills arguments with ["settlement", "KfarSPL", "0"]
 
-To execute this method, use Auxiliary::parseArguments(line)
+To execute this method, use Auxiliary::splitArguments(line, arguments)
 */
-std::vector<std::string> Auxiliary::parseArguments(const std::string& line) {
-    std::vector<std::string> arguments;
-    std::istringstream stream(line);
-    std::string argument;
+void Auxiliary::splitArguments(const std::string &line, std::vector<Argument> &arguments) {
+    splitArguments(line.data(), line.data() + line.size(), arguments);
+}
+
+// The same for the line [begin, end), which need not be a string of its own
+void Auxiliary::splitArguments(const char *begin, const char *end, std::vector<Argument> &arguments) {
+    arguments.clear();
+    const char *position = begin;
+    while (position != end) {
+        while (position != end && std::isspace(static_cast<unsigned char>(*position))) {
+            position++;
+        }
+        const char *argumentBegin = position;
+        while (position != end && !std::isspace(static_cast<unsigned char>(*position))) {
+            position++;
+        }
+        if (position != argumentBegin) {
+            Argument argument = {argumentBegin, static_cast<size_t>(position - argumentBegin)};
+            arguments.push_back(argument);
+        }
+    }
+}
+
+// Parses a whole argument as a decimal int, with an optional sign.
+// Returns false, leaving value unchanged, if it is not one or does not fit in an int.
+bool Auxiliary::parseInt(const Argument &argument, int &value) {
+    size_t position = 0;
+    bool negative = false;
+    if (argument.length > 0 && (argument.data[0] == '-' || argument.data[0] == '+')) {
+        negative = argument.data[0] == '-';
+        position++;
+    }
+    if (position == argument.length) {
+        return false;
+    }
+    const long long limit = negative ? -static_cast<long long>(INT_MIN) : INT_MAX;
+    long long result = 0;
+    for (; position < argument.length; position++) {
+        const char digit = argument.data[position];
+        if (digit < '0' || digit > '9') {
+            return false;
+        }
+        result = result * 10 + (digit - '0');
+        if (result > limit) {
+            return false;
+        }
+    }
+    value = static_cast<int>(negative ? -result : result);
+    return true;
+}
 
-    while (stream >> argument) {
-        arguments.push_back(argument);
+// Parses arguments[first, first + count) into values. False if any is missing or not an int.
+bool Auxiliary::parseInts(const std::vector<Argument> &arguments, size_t first, size_t count, int *values) {
+    if (arguments.size() < first + count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!parseInt(arguments[first + i], values[i])) {
+            return false;
+        }
     }
+    return true;
+}
+
+bool Auxiliary::isSettlementType(int value) {
+    return value >= static_cast<int>(SettlementType::VILLAGE) && value <= static_cast<int>(SettlementType::METROPOLIS);
+}
 
-    return arguments;
+bool Auxiliary::isFacilityCategory(int value) {
+    return value >= static_cast<int>(FacilityCategory::LIFE_QUALITY) && value <= static_cast<int>(FacilityCategory::ENVIRONMENT);
 }
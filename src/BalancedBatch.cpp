@@ -0,0 +1,58 @@
+#include "BalancedBatch.h"
+#include "BalancedKernel.h"
+#include <stdexcept>
+
+// Constructor
+BalancedBatch::BalancedBatch()
+    : policies(), outputs(), numOfSlots(), pending(), lifeQualityOffsets(), economyOffsets(), environmentOffsets(), picks() {}
+
+// Methods
+void BalancedBatch::clear() {
+    policies.clear();
+    outputs.clear();
+    numOfSlots.clear();
+}
+
+bool BalancedBatch::empty() const {
+    return policies.empty();
+}
+
+// Queues numOfSlots picks of policy, their catalog indices will be written to selected
+void BalancedBatch::add(BalancedSelection &policy, int *selected, int numOfSlots) {
+    policies.push_back(&policy);
+    outputs.push_back(selected);
+    this->numOfSlots.push_back(numOfSlots);
+}
+
+void BalancedBatch::select(const FacilityCatalog &facilitiesOptions) {
+    if (policies.empty()) {
+        return;
+    }
+    if (facilitiesOptions.empty()) {
+        throw std::invalid_argument("No facilities available.");
+    }
+    for (int round = 0; ; round++) {
+        pending.clear();
+        lifeQualityOffsets.clear();
+        economyOffsets.clear();
+        environmentOffsets.clear();
+        for (size_t i = 0; i < policies.size(); i++) {
+            if (numOfSlots[i] > round) {
+                pending.push_back(i);
+                lifeQualityOffsets.push_back(policies[i]->getLifeQualityScore());
+                economyOffsets.push_back(policies[i]->getEconomyScore());
+                environmentOffsets.push_back(policies[i]->getEnvironmentScore());
+            }
+        }
+        if (pending.empty()) {
+            return;
+        }
+        picks.resize(pending.size());
+        BalancedKernel::argminBatch(facilitiesOptions.getLifeQualityScores(), facilitiesOptions.getEconomyScores(), facilitiesOptions.getEnvironmentScores(), facilitiesOptions.size(),
+                                    lifeQualityOffsets.data(), economyOffsets.data(), environmentOffsets.data(), pending.size(), picks.data());
+        for (size_t i = 0; i < pending.size(); i++) {
+            policies[pending[i]]->addSelection(facilitiesOptions, picks[i]);
+            outputs[pending[i]][round] = static_cast<int>(picks[i]);
+        }
+    }
+}
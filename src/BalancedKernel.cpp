@@ -0,0 +1,168 @@
+#include "BalancedKernel.h"
+#include <algorithm>
+#include <limits>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BALANCED_KERNEL_X86
+#endif
+
+typedef size_t (*ArgminFunction)(const int*, const int*, const int*, size_t, int, int, int);
+
+static const int NO_DISTANCE = std::numeric_limits<int>::max();
+
+static int distanceOf(const int *life, const int *economy, const int *environment, size_t i, int lifeOffset, int economyOffset, int environmentOffset) {
+    int lifeQuality = life[i] + lifeOffset;
+    int economyScore = economy[i] + economyOffset;
+    int environmentScore = environment[i] + environmentOffset;
+    return std::max(lifeQuality, std::max(economyScore, environmentScore)) - std::min(lifeQuality, std::min(economyScore, environmentScore));
+}
+
+// Continues a search from the best distance and index found so far
+static size_t scalarArgminFrom(const int *life, const int *economy, const int *environment, size_t begin, size_t size, int lifeOffset, int economyOffset, int environmentOffset, int distance, size_t index) {
+    for (size_t i = begin; i < size; i++) {
+        int candidate = distanceOf(life, economy, environment, i, lifeOffset, economyOffset, environmentOffset);
+        if (candidate < distance) {
+            distance = candidate;
+            index = i;
+        }
+    }
+    return index;
+}
+
+// Lanes keep the first index of their own smallest distance, the first of the smallest wins
+static void reduceLanes(const int *distances, const int *indices, int lanes, int &distance, size_t &index) {
+    for (int lane = 0; lane < lanes; lane++) {
+        if (distances[lane] < distance || (distances[lane] == distance && static_cast<size_t>(indices[lane]) < index)) {
+            distance = distances[lane];
+            index = indices[lane];
+        }
+    }
+    if (distance == NO_DISTANCE) {
+        index = 0;
+    }
+}
+
+#ifdef BALANCED_KERNEL_X86
+__attribute__((target("avx2")))
+static size_t avx2Argmin(const int *life, const int *economy, const int *environment, size_t size, int lifeOffset, int economyOffset, int environmentOffset) {
+    const __m256i lifeOffsets = _mm256_set1_epi32(lifeOffset);
+    const __m256i economyOffsets = _mm256_set1_epi32(economyOffset);
+    const __m256i environmentOffsets = _mm256_set1_epi32(environmentOffset);
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i indices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i bestDistances = _mm256_set1_epi32(NO_DISTANCE);
+    __m256i bestIndices = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i lifeQuality = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(life + i)), lifeOffsets);
+        __m256i economyScore = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(economy + i)), economyOffsets);
+        __m256i environmentScore = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(environment + i)), environmentOffsets);
+        __m256i maxScore = _mm256_max_epi32(lifeQuality, _mm256_max_epi32(economyScore, environmentScore));
+        __m256i minScore = _mm256_min_epi32(lifeQuality, _mm256_min_epi32(economyScore, environmentScore));
+        __m256i distances = _mm256_sub_epi32(maxScore, minScore);
+        __m256i smaller = _mm256_cmpgt_epi32(bestDistances, distances);
+        bestDistances = _mm256_blendv_epi8(bestDistances, distances, smaller);
+        bestIndices = _mm256_blendv_epi8(bestIndices, indices, smaller);
+        indices = _mm256_add_epi32(indices, step);
+    }
+    alignas(32) int laneDistances[8];
+    alignas(32) int laneIndices[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(laneDistances), bestDistances);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(laneIndices), bestIndices);
+    int distance = NO_DISTANCE;
+    size_t index = 0;
+    reduceLanes(laneDistances, laneIndices, 8, distance, index);
+    return scalarArgminFrom(life, economy, environment, i, size, lifeOffset, economyOffset, environmentOffset, distance, index);
+}
+
+__attribute__((target("sse4.1")))
+static size_t sse41Argmin(const int *life, const int *economy, const int *environment, size_t size, int lifeOffset, int economyOffset, int environmentOffset) {
+    const __m128i lifeOffsets = _mm_set1_epi32(lifeOffset);
+    const __m128i economyOffsets = _mm_set1_epi32(economyOffset);
+    const __m128i environmentOffsets = _mm_set1_epi32(environmentOffset);
+    const __m128i step = _mm_set1_epi32(4);
+    __m128i indices = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i bestDistances = _mm_set1_epi32(NO_DISTANCE);
+    __m128i bestIndices = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i lifeQuality = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(life + i)), lifeOffsets);
+        __m128i economyScore = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(economy + i)), economyOffsets);
+        __m128i environmentScore = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(environment + i)), environmentOffsets);
+        __m128i maxScore = _mm_max_epi32(lifeQuality, _mm_max_epi32(economyScore, environmentScore));
+        __m128i minScore = _mm_min_epi32(lifeQuality, _mm_min_epi32(economyScore, environmentScore));
+        __m128i distances = _mm_sub_epi32(maxScore, minScore);
+        __m128i smaller = _mm_cmpgt_epi32(bestDistances, distances);
+        bestDistances = _mm_blendv_epi8(bestDistances, distances, smaller);
+        bestIndices = _mm_blendv_epi8(bestIndices, indices, smaller);
+        indices = _mm_add_epi32(indices, step);
+    }
+    alignas(16) int laneDistances[4];
+    alignas(16) int laneIndices[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(laneDistances), bestDistances);
+    _mm_store_si128(reinterpret_cast<__m128i*>(laneIndices), bestIndices);
+    int distance = NO_DISTANCE;
+    size_t index = 0;
+    reduceLanes(laneDistances, laneIndices, 4, distance, index);
+    return scalarArgminFrom(life, economy, environment, i, size, lifeOffset, economyOffset, environmentOffset, distance, index);
+}
+#endif
+
+struct ArgminImplementation {
+    ArgminFunction function;
+    const char* name;
+};
+
+static ArgminImplementation chooseImplementation() {
+#ifdef BALANCED_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        ArgminImplementation avx2 = {avx2Argmin, "avx2"};
+        return avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        ArgminImplementation sse41 = {sse41Argmin, "sse4.1"};
+        return sse41;
+    }
+#endif
+    ArgminImplementation scalar = {BalancedKernel::scalarArgmin, "scalar"};
+    return scalar;
+}
+
+static const ArgminImplementation &getImplementation() {
+    static const ArgminImplementation implementation = chooseImplementation();
+    return implementation;
+}
+
+const size_t BalancedKernel::TILE_SIZE;
+
+// Methods
+size_t BalancedKernel::argmin(const int *lifeQualityScores, const int *economyScores, const int *environmentScores, size_t size, int lifeQualityOffset, int economyOffset, int environmentOffset) {
+    return getImplementation().function(lifeQualityScores, economyScores, environmentScores, size, lifeQualityOffset, economyOffset, environmentOffset);
+}
+
+size_t BalancedKernel::scalarArgmin(const int *lifeQualityScores, const int *economyScores, const int *environmentScores, size_t size, int lifeQualityOffset, int economyOffset, int environmentOffset) {
+    return scalarArgminFrom(lifeQualityScores, economyScores, environmentScores, 0, size, lifeQualityOffset, economyOffset, environmentOffset, NO_DISTANCE, 0);
+}
+
+/*
+Same result as calling argmin for every query. Each tile is searched for all the queries
+before moving on, and a tile's best only replaces the best so far if it is strictly closer,
+so the first index of the smallest distance still wins. size must not be 0.
+*/
+void BalancedKernel::argminBatch(const int *lifeQualityScores, const int *economyScores, const int *environmentScores, size_t size, const int *lifeQualityOffsets, const int *economyOffsets, const int *environmentOffsets, size_t numOfQueries, size_t *indices) {
+    const ArgminFunction function = getImplementation().function;
+    for (size_t begin = 0; begin < size; begin += TILE_SIZE) {
+        const size_t tileSize = std::min(TILE_SIZE, size - begin);
+        for (size_t query = 0; query < numOfQueries; query++) {
+            const size_t index = begin + function(lifeQualityScores + begin, economyScores + begin, environmentScores + begin, tileSize, lifeQualityOffsets[query], economyOffsets[query], environmentOffsets[query]);
+            if (begin == 0 || distanceOf(lifeQualityScores, economyScores, environmentScores, index, lifeQualityOffsets[query], economyOffsets[query], environmentOffsets[query]) < distanceOf(lifeQualityScores, economyScores, environmentScores, indices[query], lifeQualityOffsets[query], economyOffsets[query], environmentOffsets[query])) {
+                indices[query] = index;
+            }
+        }
+    }
+}
+
+const char* BalancedKernel::getName() {
+    return getImplementation().name;
+}
@@ -0,0 +1,102 @@
+#include "Checkpoints.h"
+#include "OutputWriter.h"
+#include <iostream>
+
+Checkpoints checkpoints;
+
+// Constructor
+Checkpoints::Checkpoint::Checkpoint(const string &name, const string &parent, Simulation *simulation)
+    : name(name), parent(parent), simulation(simulation) {}
+
+Checkpoints::Checkpoints() : checkpoints(), current(), backupParent() {}
+
+// Destructor
+Checkpoints::~Checkpoints() {
+    for (size_t i = 0; i < checkpoints.size(); i++) {
+        delete checkpoints[i].simulation;
+    }
+    checkpoints.clear();
+}
+
+// Methods
+// O(1): the new checkpoint shares all of its state with the simulation
+void Checkpoints::save(const string &name, const Simulation &simulation) {
+    const string parent = (current == name ? checkpoints[find(name)].parent : current);
+    drop(name);
+    checkpoints.push_back(Checkpoint(name, parent, new Simulation(simulation)));
+    current = name;
+}
+
+bool Checkpoints::restore(const string &name, Simulation &simulation) {
+    const int index = find(name);
+    if (index == -1) {
+        return false;
+    }
+    simulation = *checkpoints[index].simulation;
+    current = name;
+    return true;
+}
+
+// The children of a dropped checkpoint become children of its parent
+bool Checkpoints::drop(const string &name) {
+    const int index = find(name);
+    if (index == -1) {
+        return false;
+    }
+    const string parent = checkpoints[index].parent;
+    for (Checkpoint &checkpoint : checkpoints) {
+        if (checkpoint.parent == name) {
+            checkpoint.parent = parent;
+        }
+    }
+    if (current == name) {
+        current = parent;
+    }
+    if (backupParent == name) {
+        backupParent = parent;
+    }
+    delete checkpoints[index].simulation;
+    checkpoints.erase(checkpoints.begin() + index);
+    return true;
+}
+
+/*
+The unnamed backup is a copy of the simulation too, so restoring it goes back to the parent
+the simulation had when it was taken; a loaded simulation has none.
+*/
+void Checkpoints::saveBackup() {
+    backupParent = current;
+}
+
+void Checkpoints::restoreBackup() {
+    current = backupParent;
+}
+
+void Checkpoints::forgetCurrent() {
+    current.clear();
+}
+
+// One line per checkpoint, with what it changed since its parent
+void Checkpoints::print() const {
+    for (const Checkpoint &checkpoint : checkpoints) {
+        const int parentIndex = find(checkpoint.parent);
+        SimulationDelta delta = (parentIndex == -1 ? checkpoint.simulation->diff(nullptr) : checkpoint.simulation->diff(checkpoints[parentIndex].simulation));
+        output << checkpoint.name << " tick " << checkpoint.simulation->getCurrentTick()
+               << " parent " << (parentIndex == -1 ? "none" : checkpoint.parent)
+               << ": " << delta.changedPlans << " changed plans, " << delta.newFacilities << " new facilities, "
+               << delta.newActions << " new actions" << '\n';
+    }
+}
+
+bool Checkpoints::empty() const {
+    return checkpoints.empty();
+}
+
+int Checkpoints::find(const string &name) const {
+    for (size_t i = 0; i < checkpoints.size(); i++) {
+        if (checkpoints[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,171 @@
+#include "ConfigImage.h"
+#include "MappedFile.h"
+#include "SelectionPolicy.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+const char ConfigImage::MAGIC[8] = {'S', 'I', 'M', 'C', 'O', 'N', 'F', '\x01'};
+
+static uint64_t alignTo8(uint64_t offset) {
+    return (offset + 7) / 8 * 8;
+}
+
+template <typename T>
+static void writeRecords(std::ofstream &file, const vector<T> &records, uint64_t offset) {
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(T)));
+}
+
+// Methods
+// Writes the settlements, catalog and plans of a simulation that was just read from a text config
+void ConfigImage::compile(const Simulation &simulation, const string &path) {
+    string strings;
+    const vector<std::shared_ptr<Settlement>> &settlements = simulation.settlements.get();
+    std::unordered_map<const Settlement*, int32_t> settlementIndex;
+    vector<SettlementRecord> settlementRecords(settlements.size());
+    for (size_t i = 0; i < settlements.size(); i++) {
+        SettlementRecord &record = settlementRecords[i];
+        std::memset(&record, 0, sizeof(SettlementRecord));
+        record.name.offset = strings.size();
+        record.name.length = static_cast<uint32_t>(settlements[i]->getName().size());
+        record.type = static_cast<int32_t>(settlements[i]->getType());
+        strings += settlements[i]->getName();
+        settlementIndex[settlements[i].get()] = static_cast<int32_t>(i);
+    }
+
+    const FacilityCatalog &catalog = simulation.facilitiesOptions.get();
+    vector<StringRef> facilityNames(catalog.size());
+    vector<int32_t> categories(catalog.size()), prices(catalog.size());
+    vector<int32_t> lifeQualityScores(catalog.getLifeQualityScores(), catalog.getLifeQualityScores() + catalog.size());
+    vector<int32_t> economyScores(catalog.getEconomyScores(), catalog.getEconomyScores() + catalog.size());
+    vector<int32_t> environmentScores(catalog.getEnvironmentScores(), catalog.getEnvironmentScores() + catalog.size());
+    for (size_t i = 0; i < catalog.size(); i++) {
+        std::memset(&facilityNames[i], 0, sizeof(StringRef));
+        facilityNames[i].offset = strings.size();
+        facilityNames[i].length = static_cast<uint32_t>(catalog[i].getName().size());
+        strings += catalog[i].getName();
+        categories[i] = static_cast<int32_t>(catalog[i].getCategory());
+        prices[i] = catalog[i].getCost();
+    }
+
+    const SharedChunkList<CopyOnWrite<Plan>> &plans = simulation.plans;
+    vector<PlanRecord> planRecords(plans.size());
+    for (size_t i = 0; i < plans.size(); i++) {
+        const Plan &plan = plans[i].get();
+        planRecords[i].settlement = settlementIndex.at(&plan.getSettlement());
+        planRecords[i].policy = SelectionPolicy::findPolicy(plan.getSelectionPolicy()->toString());
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.stringsSize = strings.size();
+    header.stringsOffset = alignTo8(sizeof(Header));
+    header.numOfSettlements = settlementRecords.size();
+    header.settlementsOffset = alignTo8(header.stringsOffset + strings.size());
+    header.numOfFacilityTypes = catalog.size();
+    header.facilityNamesOffset = alignTo8(header.settlementsOffset + settlementRecords.size() * sizeof(SettlementRecord));
+    header.categoriesOffset = alignTo8(header.facilityNamesOffset + catalog.size() * sizeof(StringRef));
+    header.pricesOffset = alignTo8(header.categoriesOffset + catalog.size() * sizeof(int32_t));
+    header.lifeQualityScoresOffset = alignTo8(header.pricesOffset + catalog.size() * sizeof(int32_t));
+    header.economyScoresOffset = alignTo8(header.lifeQualityScoresOffset + catalog.size() * sizeof(int32_t));
+    header.environmentScoresOffset = alignTo8(header.economyScoresOffset + catalog.size() * sizeof(int32_t));
+    header.numOfPlans = planRecords.size();
+    header.plansOffset = alignTo8(header.environmentScoresOffset + catalog.size() * sizeof(int32_t));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to write config image");
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.seekp(static_cast<std::streamoff>(header.stringsOffset));
+    file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+    writeRecords(file, settlementRecords, header.settlementsOffset);
+    writeRecords(file, facilityNames, header.facilityNamesOffset);
+    writeRecords(file, categories, header.categoriesOffset);
+    writeRecords(file, prices, header.pricesOffset);
+    writeRecords(file, lifeQualityScores, header.lifeQualityScoresOffset);
+    writeRecords(file, economyScores, header.economyScoresOffset);
+    writeRecords(file, environmentScores, header.environmentScoresOffset);
+    writeRecords(file, planRecords, header.plansOffset);
+    if (!file) {
+        throw std::runtime_error("Unable to write config image");
+    }
+}
+
+bool ConfigImage::isImage(const string &path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/*
+Fills an empty simulation from the image. Every container is sized once up front, plan IDs
+are the record indices, and every plan starts available, so the ID index and the ready
+list are filled directly instead of through addPlan.
+*/
+void ConfigImage::load(const string &path, Simulation &simulation) {
+    MappedFile file(path, "config image");
+    const Header *header = file.records<Header>(0, 1);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION) {
+        throw std::runtime_error("Invalid config image");
+    }
+    const char *strings = file.records<char>(header->stringsOffset, header->stringsSize);
+    const SettlementRecord *settlementRecords = file.records<SettlementRecord>(header->settlementsOffset, header->numOfSettlements);
+    const StringRef *facilityNames = file.records<StringRef>(header->facilityNamesOffset, header->numOfFacilityTypes);
+    const int32_t *categories = file.records<int32_t>(header->categoriesOffset, header->numOfFacilityTypes);
+    const int32_t *prices = file.records<int32_t>(header->pricesOffset, header->numOfFacilityTypes);
+    const int32_t *lifeQualityScores = file.records<int32_t>(header->lifeQualityScoresOffset, header->numOfFacilityTypes);
+    const int32_t *economyScores = file.records<int32_t>(header->economyScoresOffset, header->numOfFacilityTypes);
+    const int32_t *environmentScores = file.records<int32_t>(header->environmentScoresOffset, header->numOfFacilityTypes);
+    const PlanRecord *planRecords = file.records<PlanRecord>(header->plansOffset, header->numOfPlans);
+    auto readString = [&](const StringRef &ref) {
+        if (ref.offset > header->stringsSize || ref.length > header->stringsSize - ref.offset) {
+            throw std::runtime_error("Invalid config image");
+        }
+        return ref.length == 0 ? string() : string(strings + ref.offset, ref.length);
+    };
+
+    vector<std::shared_ptr<Settlement>> &settlements = simulation.settlements.edit();
+    std::unordered_map<string, Settlement*> &settlementsByName = simulation.settlementsByName.edit();
+    settlements.reserve(header->numOfSettlements);
+    settlementsByName.reserve(header->numOfSettlements);
+    for (uint64_t i = 0; i < header->numOfSettlements; i++) {
+        const SettlementRecord &record = settlementRecords[i];
+        if (record.type < 0 || record.type > static_cast<int32_t>(SettlementType::METROPOLIS)) {
+            throw std::runtime_error("Invalid config image");
+        }
+        settlements.push_back(std::make_shared<Settlement>(readString(record.name), static_cast<SettlementType>(record.type)));
+        if (!settlementsByName.insert(std::make_pair(settlements.back()->getName(), settlements.back().get())).second) {
+            throw std::runtime_error("Invalid config image");
+        }
+    }
+
+    FacilityCatalog &catalog = simulation.facilitiesOptions.edit();
+    catalog.reserve(header->numOfFacilityTypes);
+    for (uint64_t i = 0; i < header->numOfFacilityTypes; i++) {
+        if (categories[i] < 0 || categories[i] > static_cast<int32_t>(FacilityCategory::ENVIRONMENT)
+            || !catalog.add(FacilityType(readString(facilityNames[i]), static_cast<FacilityCategory>(categories[i]), prices[i], lifeQualityScores[i], economyScores[i], environmentScores[i]))) {
+            throw std::runtime_error("Invalid config image");
+        }
+    }
+
+    SharedChunkList<CopyOnWrite<Plan>> &plans = simulation.plans;
+    SharedChunkList<int> &planIndexById = simulation.planIndexById;
+    vector<int> &readyPlans = simulation.readyPlans.edit();
+    readyPlans.reserve(header->numOfPlans);
+    for (uint64_t i = 0; i < header->numOfPlans; i++) {
+        const PlanRecord &record = planRecords[i];
+        if (record.settlement < 0 || static_cast<uint64_t>(record.settlement) >= header->numOfSettlements
+            || record.policy < 0 || record.policy >= SelectionPolicy::NUM_OF_POLICIES) {
+            throw std::runtime_error("Invalid config image");
+        }
+        SelectionPolicy *policy = SelectionPolicy::create(record.policy);
+        plans.push_back(CopyOnWrite<Plan>(new Plan(static_cast<int>(i), *settlements[record.settlement], policy)));
+        planIndexById.push_back(static_cast<int>(i));
+        readyPlans.push_back(static_cast<int>(i));
+    }
+    simulation.planCounter = static_cast<int>(header->numOfPlans);
+}
@@ -0,0 +1,111 @@
+#include "ConfigLoader.h"
+#include "Auxiliary.h"
+#include "MappedFile.h"
+#include "SelectionPolicy.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+// Methods
+void ConfigLoader::load(const string &path, Simulation &simulation) {
+    MappedFile file(path, "config file");
+    const char *data = file.getData();
+    const size_t size = file.getSize();
+
+    int numOfChunks = 1;
+    if (simulation.workerPool != nullptr && size >= PARALLEL_MIN_BYTES) {
+        numOfChunks = simulation.workerPool->size() * Simulation::CHUNKS_PER_WORKER;
+    }
+    vector<Chunk> chunks(numOfChunks);
+    for (int i = 1; i < numOfChunks; i++) {
+        size_t begin = std::max(chunks[i - 1].begin, size / numOfChunks * i);
+        const void *lineEnd = begin < size ? std::memchr(data + begin, '\n', size - begin) : nullptr;
+        begin = lineEnd == nullptr ? size : static_cast<const char*>(lineEnd) - data + 1;
+        chunks[i - 1].end = begin;
+        chunks[i].begin = begin;
+    }
+    chunks.back().end = size;
+    simulation.runChunks(numOfChunks, [data, &chunks](int chunk, int worker) {
+        parse(data, chunks[chunk]);
+    });
+
+    int lineNumber = 0;
+    for (const Chunk &chunk : chunks) {
+        for (const Entry &entry : chunk.entries) {
+            add(entry, simulation);
+        }
+        lineNumber += chunk.numOfLines;
+        if (!chunk.invalidLine.empty()) {
+            throw std::runtime_error("Invalid config line " + std::to_string(lineNumber) + ": " + chunk.invalidLine);
+        }
+    }
+}
+
+// Parses the lines of a chunk, stopping after the first malformed one
+void ConfigLoader::parse(const char *data, Chunk &chunk) {
+    vector<Argument> arguments;
+    const char *position = data + chunk.begin;
+    const char *end = data + chunk.end;
+    while (position != end) {
+        const char *lineEnd = static_cast<const char*>(std::memchr(position, '\n', end - position));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        const char *lineBegin = position;
+        position = lineEnd == end ? end : lineEnd + 1;
+        chunk.numOfLines++;
+        Auxiliary::splitArguments(lineBegin, lineEnd, arguments);
+        if (arguments.empty()) {
+            continue;
+        }
+        Entry entry;
+        bool valid = true;
+        if (arguments[0] == "settlement") {
+            entry.type = EntryType::SETTLEMENT;
+            valid = Auxiliary::parseInts(arguments, 2, 1, entry.values) && Auxiliary::isSettlementType(entry.values[0]);
+        }
+        else if (arguments[0] == "facility") {
+            entry.type = EntryType::FACILITY;
+            valid = Auxiliary::parseInts(arguments, 2, 5, entry.values) && Auxiliary::isFacilityCategory(entry.values[0]);
+        }
+        else if (arguments[0] == "plan") {
+            entry.type = EntryType::PLAN;
+            valid = arguments.size() > 2;
+            if (valid) {
+                entry.policy = arguments[2].str();
+            }
+        }
+        else {
+            continue;  // Comments, and lines the config does not use
+        }
+        if (!valid) {
+            chunk.invalidLine.assign(lineBegin, lineEnd);
+            return;
+        }
+        entry.name = arguments[1].str();
+        chunk.entries.push_back(std::move(entry));
+    }
+}
+
+void ConfigLoader::add(const Entry &entry, Simulation &simulation) {
+    if (entry.type == EntryType::SETTLEMENT) {
+        std::unique_ptr<Settlement> settlement(new Settlement(entry.name, static_cast<SettlementType>(entry.values[0])));
+        if (simulation.addSettlement(settlement.get())) {
+            settlement.release();
+        }
+    }
+    else if (entry.type == EntryType::FACILITY) {
+        if (!simulation.addFacility(FacilityType(entry.name, static_cast<FacilityCategory>(entry.values[0]), entry.values[1], entry.values[2], entry.values[3], entry.values[4]))) {
+            throw std::runtime_error("Facility already exists");
+        }
+    }
+    else {
+        Settlement &settlement = simulation.getSettlement(entry.name);
+        const int policy = SelectionPolicy::findPolicy(entry.policy);
+        if (policy == -1) {
+            throw std::runtime_error("Cannot create this plan");
+        }
+        simulation.addPlan(settlement, SelectionPolicy::create(policy));
+    }
+}
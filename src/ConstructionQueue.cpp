@@ -0,0 +1,94 @@
+#include "ConstructionQueue.h"
+#include <stdexcept>
+
+// Constructor
+ConstructionQueue::ConstructionQueue() : count(0), finishTicks(), typeIds(), lifeQualityScores(), economyScores(), environmentScores() {}
+
+// Methods
+int ConstructionQueue::size() const {
+    return count;
+}
+
+int ConstructionQueue::getTypeId(int slot) const {
+    return typeIds[slot];
+}
+
+int ConstructionQueue::getFinishTick(int slot) const {
+    return finishTicks[slot];
+}
+
+// Time left after the given tick was simulated
+int ConstructionQueue::getTimeLeft(int slot, const int tick) const {
+    return finishTicks[slot] - tick;
+}
+
+// The first tick after the given one in which a facility finishes, or -1 if none will
+int ConstructionQueue::nextFinishTick(const int tick) const {
+    int next = -1;
+    for (int i = 0; i < count; i++) {
+        if (finishTicks[i] > tick && (next == -1 || finishTicks[i] < next)) {
+            next = finishTicks[i];
+        }
+    }
+    return next;
+}
+
+/*
+Starts building a facility in the given tick. It counts down once in that tick, so it
+becomes operational in tick + price - 1. A facility without a positive price never
+reaches zero, and its finish tick is already in the past.
+*/
+void ConstructionQueue::push(const FacilityType &type, const int typeId, const int tick) {
+    resume(type, typeId, tick + type.getCost() - 1);
+}
+
+// Adds a facility that was started earlier and finishes in the given tick
+void ConstructionQueue::resume(const FacilityType &type, const int typeId, const int finishTick) {
+    if (count == CAPACITY) {
+        throw std::runtime_error("Construction queue is full");
+    }
+    finishTicks[count] = finishTick;
+    typeIds[count] = typeId;
+    lifeQualityScores[count] = type.getLifeQualityScore();
+    economyScores[count] = type.getEconomyScore();
+    environmentScores[count] = type.getEnvironmentScore();
+    count++;
+}
+
+// Moves the facilities that are still expected to finish after the given tick by a number of ticks
+void ConstructionQueue::postpone(const int tick, const int ticks) {
+    for (int i = 0; i < count; i++) {
+        if (finishTicks[i] > tick) {
+            finishTicks[i] += ticks;
+        }
+    }
+}
+
+/*
+Checks every slot against the tick in one pass. Facilities finishing in it are written to
+completedTypeIds in queue order and their scores are added to the given totals; the
+remaining slots are compacted in place, keeping their order.
+Returns the number of completed facilities.
+*/
+int ConstructionQueue::complete(const int tick, int *completedTypeIds, int &lifeQualityScore, int &economyScore, int &environmentScore) {
+    int completed = 0;
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        const int done = (finishTicks[i] == tick);
+        const int mask = -done;
+        lifeQualityScore += lifeQualityScores[i] & mask;
+        economyScore += economyScores[i] & mask;
+        environmentScore += environmentScores[i] & mask;
+        completedTypeIds[completed] = typeIds[i];
+        completed += done;
+
+        finishTicks[kept] = finishTicks[i];
+        typeIds[kept] = typeIds[i];
+        lifeQualityScores[kept] = lifeQualityScores[i];
+        economyScores[kept] = economyScores[i];
+        environmentScores[kept] = environmentScores[i];
+        kept += 1 - done;
+    }
+    count = kept;
+    return completed;
+}
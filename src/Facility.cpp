@@ -1,17 +1,34 @@
 #include "Facility.h"
+#include "Settlement.h"
 
 // Constructor
-Facility::Facility(const string &name, const string &settlementName, const FacilityCategory category, const int price, const int lifeQuality_score, const int economy_score, const int environment_score)
-    : FacilityType(name, category, price, lifeQuality_score, economy_score, environment_score), 
-      settlementName(settlementName),
-      status(FacilityStatus::UNDER_CONSTRUCTIONS), 
-      timeLeft(price) {}
+Facility::Facility(const FacilityType &type, const int typeId, const Settlement &settlement)
+    : settlement(&settlement),
+      typeId(typeId),
+      timeLeft(type.getCost()),
+      status(FacilityStatus::UNDER_CONSTRUCTIONS) {}
 
-Facility::Facility(const FacilityType &type, const string &settlementName):FacilityType(type.getName(),type.getCategory(),type.getCost(),type.getLifeQualityScore(),type.getEconomyScore(),type.getEnvironmentScore()),settlementName(settlementName),status(FacilityStatus::UNDER_CONSTRUCTIONS),timeLeft(type.getCost()) {}
+Facility::Facility(const int typeId, const Settlement &settlement)
+    : settlement(&settlement), typeId(typeId), timeLeft(0), status(FacilityStatus::OPERATIONAL) {}
+
+Facility::Facility(const Facility &other, const Settlement &otherSettlement)
+    : settlement(&otherSettlement), typeId(other.typeId), timeLeft(other.timeLeft), status(other.status) {}
 
 // Methods
+int Facility::getTypeId() const {
+    return typeId;
+}
+
+const FacilityType &Facility::getType(const vector<FacilityType> &facilityOptions) const {
+    return facilityOptions[typeId];
+}
+
+const Settlement &Facility::getSettlement() const {
+    return *settlement;
+}
+
 const string &Facility::getSettlementName() const {
-    return settlementName;
+    return settlement->getName();
 }
 
 const int Facility::getTimeLeft() const {
@@ -0,0 +1,76 @@
+#include "FacilityCatalog.h"
+
+// Constructor
+FacilityCatalog::FacilityCatalog() : facilities(), categoryIndices(), indexByName(), lifeQualityScores(), economyScores(), environmentScores() {}
+
+// Methods
+// Returns false if a facility with the same name is already in the catalog
+bool FacilityCatalog::add(const FacilityType &facility) {
+    const int index = static_cast<int>(facilities.size());
+    if (!indexByName.insert(std::make_pair(facility.getName(), index)).second) {
+        return false;
+    }
+    facilities.push_back(facility);
+    categoryIndices[static_cast<int>(facility.getCategory())].push_back(index);
+    lifeQualityScores.push_back(facility.getLifeQualityScore());
+    economyScores.push_back(facility.getEconomyScore());
+    environmentScores.push_back(facility.getEnvironmentScore());
+    return true;
+}
+
+bool FacilityCatalog::contains(const string &facilityName) const {
+    return indexByName.count(facilityName) != 0;
+}
+
+void FacilityCatalog::clear() {
+    facilities.clear();
+    for (int i = 0; i < NUM_OF_CATEGORIES; i++) {
+        categoryIndices[i].clear();
+    }
+    indexByName.clear();
+    lifeQualityScores.clear();
+    economyScores.clear();
+    environmentScores.clear();
+}
+
+// For bulk loading, so adding numOfFacilities types does not reallocate
+void FacilityCatalog::reserve(size_t numOfFacilities) {
+    facilities.reserve(numOfFacilities);
+    indexByName.reserve(numOfFacilities);
+    lifeQualityScores.reserve(numOfFacilities);
+    economyScores.reserve(numOfFacilities);
+    environmentScores.reserve(numOfFacilities);
+}
+
+size_t FacilityCatalog::size() const {
+    return facilities.size();
+}
+
+bool FacilityCatalog::empty() const {
+    return facilities.empty();
+}
+
+const FacilityType &FacilityCatalog::operator[](size_t index) const {
+    return facilities[index];
+}
+
+const vector<FacilityType> &FacilityCatalog::getFacilities() const {
+    return facilities;
+}
+
+// Indices into the catalog of the facilities of a category, in increasing order
+const vector<int> &FacilityCatalog::getCategoryIndices(FacilityCategory category) const {
+    return categoryIndices[static_cast<int>(category)];
+}
+
+const int *FacilityCatalog::getLifeQualityScores() const {
+    return lifeQualityScores.data();
+}
+
+const int *FacilityCatalog::getEconomyScores() const {
+    return economyScores.data();
+}
+
+const int *FacilityCatalog::getEnvironmentScores() const {
+    return environmentScores.data();
+}
@@ -0,0 +1,512 @@
+#include "Journal.h"
+#include "Action.h"
+#include "Auxiliary.h"
+#include "Checkpoints.h"
+#include "MappedFile.h"
+#include "OutputWriter.h"
+#include "Snapshot.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+Journal journal;
+
+const char Journal::MAGIC[8] = {'S', 'I', 'M', 'J', 'R', 'N', 'L', '\x01'};
+const int Journal::SYNC_INTERVAL_MS;
+
+static void writeAll(int descriptor, const char *data, size_t length) {
+    while (length > 0) {
+        const ssize_t written = ::write(descriptor, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Cannot write the journal");
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
+
+// Makes what was written to the file at path durable
+static void syncFile(const string &path) {
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor == -1 || ::fsync(descriptor) != 0) {
+        if (descriptor != -1) {
+            ::close(descriptor);
+        }
+        throw std::runtime_error("Cannot sync " + path);
+    }
+    ::close(descriptor);
+}
+
+// Makes a rename or a new file in the directory of path durable
+static void syncDirectory(const string &path) {
+    const size_t slash = path.rfind('/');
+    syncFile(slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash));
+}
+
+static uint32_t checksum(const char *data, size_t length) {
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+static void appendValue(string &entry, T value) {
+    entry.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Constructor
+Journal::Journal() : path(), generation(0), numOfEntries(0), descriptor(-1), entry(), dirty(false), stopping(false), mutex(), wake(), syncer() {}
+
+// Destructor
+Journal::~Journal() {
+    close();
+}
+
+// Methods
+/*
+Starts a new journal at path, replacing any there, with the simulation as it is now as its
+first checkpoint.
+*/
+void Journal::create(const string &path, const Simulation &simulation) {
+    close();
+    this->path = path;
+    generation = 0;
+    saveCheckpoint(simulation, generation);
+    replace(generation);
+}
+
+/*
+Rebuilds the simulation of the journal at path, as replay() does, and cuts the journal after
+the last entry run (the crash the journal is recovered from came after it). The journal is
+then open, and what the simulation runs next is appended.
+*/
+Simulation Journal::recover(const string &path, const int numOfThreads) {
+    close();
+    const int outputDescriptor = output.setDescriptor(OutputWriter::DISCARD);
+    const int errorsDescriptor = errors.setDescriptor(OutputWriter::DISCARD);
+    Replayed replayed;
+    Simulation simulation = replay(path, numOfThreads, replayed);
+    output.setDescriptor(outputDescriptor);
+    errors.setDescriptor(errorsDescriptor);
+    this->path = path;
+    generation = replayed.generation;
+    numOfEntries = replayed.numOfEntries;
+
+    // Left behind by a checkpoint the crash interrupted, before or after its rename
+    std::remove((path + ".tmp").c_str());
+    removeCheckpoint(generation + 1);
+    if (generation > 0) {
+        removeCheckpoint(generation - 1);
+    }
+    descriptor = ::open(path.c_str(), O_WRONLY | O_APPEND);
+    if (descriptor == -1 || ::ftruncate(descriptor, static_cast<off_t>(replayed.end)) != 0) {
+        throw std::runtime_error("Cannot open journal " + path);
+    }
+    stopping = false;
+    syncer = std::thread(&Journal::syncLoop, this);
+    return simulation;
+}
+
+/*
+Loads the checkpoint of the journal at path, starts it and runs the journal's entries
+again. Stops at the first entry that is cut short or corrupt, or whose action throws.
+What the actions print goes to output as usual, it is up to the caller to divert it.
+*/
+Simulation Journal::replay(const string &path, const int numOfThreads, Replayed &replayed) {
+    MappedFile file(path, "journal");
+    const Header *header = file.records<Header>(0, 1);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION) {
+        throw std::runtime_error("Invalid journal");
+    }
+    replayed.generation = header->generation;
+    Simulation simulation = loadCheckpoint(getCheckpointPath(path, replayed.generation));
+    simulation.setNumOfThreads(numOfThreads);
+    simulation.open();  // The entries were run by a started simulation
+
+    const char *data = file.getData();
+    const size_t size = file.getSize();
+    replayed.end = sizeof(Header);
+    replayed.numOfEntries = 0;
+    ActionLog::Record record;
+    ActionLog strings;  // of the entries; a log only to hold them
+    while (size - replayed.end >= sizeof(EntryHeader)) {
+        EntryHeader entryHeader;
+        std::memcpy(&entryHeader, data + replayed.end, sizeof(EntryHeader));
+        const char *payload = data + replayed.end + sizeof(EntryHeader);
+        if (entryHeader.size > size - replayed.end - sizeof(EntryHeader) || checksum(payload, entryHeader.size) != entryHeader.checksum
+            || !decode(payload, entryHeader.size, record, strings)) {
+            break;
+        }
+        try {
+            if (record.kind == ActionLog::Kind::SAVE) {
+                // Logged as it ran, without writing its file again
+                ActionLog &log = simulation.actionsLog.edit();
+                record.args[0] = log.intern(strings.getString(record.args[0]));
+                log.append(record);
+            } else {
+                simulation.addAction(BaseAction::fromRecord(record, strings));
+            }
+        } catch (const std::exception&) {
+            break;
+        }
+        replayed.end += sizeof(EntryHeader) + entryHeader.size;
+        replayed.numOfEntries++;
+    }
+    return simulation;
+}
+
+// Whether the file at path starts as a journal does
+bool Journal::isJournal(const string &path) {
+    char magic[sizeof(MAGIC)];
+    std::ifstream file(path, std::ios::binary);
+    return file.read(magic, sizeof(MAGIC)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool Journal::isOpen() const {
+    return descriptor != -1;
+}
+
+// Writes an entry for the action of record, a record of log, which is about to run; a save's after it runs
+void Journal::beforeAction(const ActionLog::Record &record, const ActionLog &log) {
+    if (record.kind != ActionLog::Kind::SAVE) {
+        append(record, log);
+    }
+}
+
+// Writes the entry of a save, with its outcome, and takes a checkpoint after a load or if one is due
+void Journal::afterAction(const ActionLog::Record &record, const Simulation &simulation) {
+    if (record.kind == ActionLog::Kind::SAVE) {
+        append(record, simulation.actionsLog.get());
+    }
+    const bool loaded = record.kind == ActionLog::Kind::LOAD && record.completed;
+    if (numOfEntries < CHECKPOINT_ENTRIES && !loaded) {
+        return;
+    }
+    try {
+        checkpoint(simulation);
+    } catch (const std::runtime_error &e) {
+        // The journal still holds every entry; the next attempt is CHECKPOINT_ENTRIES later
+        output.flush();
+        errors << "Journal checkpoint failed: " << e.what() << '\n';
+        errors.flush();
+    }
+    numOfEntries = 0;
+}
+
+void Journal::append(const ActionLog::Record &record, const ActionLog &log) {
+    entry.assign(sizeof(EntryHeader), '\0');
+    entry += static_cast<char>(static_cast<unsigned char>(record.kind) | (record.completed ? 0 : FAILED));
+    for (int i = 0; i < ActionLog::getNumOfArgs(record.kind); i++) {
+        if (!ActionLog::isStringArg(record.kind, i)) {
+            appendValue<int32_t>(entry, record.args[i]);
+        } else if (record.args[i] == -1) {
+            appendValue<uint32_t>(entry, NO_STRING);
+        } else {
+            const string &text = log.getString(record.args[i]);
+            appendValue<uint32_t>(entry, static_cast<uint32_t>(text.size()));
+            entry += text;
+        }
+    }
+    EntryHeader entryHeader;
+    entryHeader.size = static_cast<uint32_t>(entry.size() - sizeof(EntryHeader));
+    entryHeader.checksum = checksum(entry.data() + sizeof(EntryHeader), entryHeader.size);
+    std::memcpy(&entry[0], &entryHeader, sizeof(EntryHeader));
+    writeAll(descriptor, entry.data(), entry.size());
+    dirty = true;
+    numOfEntries++;
+}
+
+// Syncs what is left and closes the journal
+void Journal::close() {
+    if (descriptor == -1) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    syncer.join();
+    ::fdatasync(descriptor);
+    ::close(descriptor);
+    descriptor = -1;
+}
+
+string Journal::getCheckpointPath(const string &path, uint64_t generation) {
+    return path + "." + std::to_string(generation);
+}
+
+/*
+Saves the simulation as the next generation, then replaces the journal with an empty one
+naming it. Until the rename the old journal and checkpoint are the ones recovered, after it
+the new ones; the old checkpoint is removed last.
+*/
+void Journal::checkpoint(const Simulation &simulation) {
+    saveCheckpoint(simulation, generation + 1);
+    replace(generation + 1);
+    removeCheckpoint(generation - 1);
+}
+
+// Saves the simulation and the backups of the session as the checkpoint of generation, durably
+void Journal::saveCheckpoint(const Simulation &simulation, uint64_t generation) {
+    removeCheckpoint(generation);  // Left behind by an attempt that failed
+    const string checkpointPath = getCheckpointPath(path, generation);
+    Snapshot::save(simulation, checkpointPath);
+    syncFile(checkpointPath);
+    if (backup == nullptr && checkpoints.empty()) {
+        return;
+    }
+    // Names come from whitespace separated commands, so a line lists them unquoted
+    vector<const Simulation*> simulations;
+    std::unordered_map<const Plan*, size_t> owners;
+    string backups;
+    if (backup != nullptr) {
+        Snapshot::save(*backup, checkpointPath + ".backup");
+        syncFile(checkpointPath + ".backup");
+        simulations.push_back(backup);
+        backups += "backup" + (checkpoints.backupParent.empty() ? "" : " " + checkpoints.backupParent) + "\n";
+        backups += getSharedPlans(simulations, simulations.size() - 1, owners);
+    }
+    for (size_t i = 0; i < checkpoints.checkpoints.size(); i++) {
+        const Checkpoints::Checkpoint &saved = checkpoints.checkpoints[i];
+        const string savedPath = checkpointPath + ".checkpoint" + std::to_string(i);
+        Snapshot::save(*saved.simulation, savedPath);
+        syncFile(savedPath);
+        simulations.push_back(saved.simulation);
+        backups += "checkpoint " + saved.name + (saved.parent.empty() ? "" : " " + saved.parent) + "\n";
+        backups += getSharedPlans(simulations, simulations.size() - 1, owners);
+    }
+    simulations.push_back(&simulation);
+    backups += "current" + (checkpoints.current.empty() ? "" : " " + checkpoints.current) + "\n";
+    backups += getSharedPlans(simulations, simulations.size() - 1, owners);
+    const string backupsPath = checkpointPath + ".backups";
+    std::ofstream file(backupsPath, std::ios::binary | std::ios::trunc);
+    if (!file.write(backups.data(), backups.size()) || !file.flush()) {
+        throw std::runtime_error("Cannot write " + backupsPath);
+    }
+    file.close();
+    syncFile(backupsPath);
+}
+
+void Journal::removeCheckpoint(uint64_t generation) {
+    const string checkpointPath = getCheckpointPath(path, generation);
+    std::remove(checkpointPath.c_str());
+    std::remove((checkpointPath + ".backup").c_str());
+    std::remove((checkpointPath + ".backups").c_str());
+    for (int i = 0; std::remove((checkpointPath + ".checkpoint" + std::to_string(i)).c_str()) == 0; i++) {}
+}
+
+/*
+Loads the simulation saved as the checkpoint at checkpointPath, and replaces the backups of
+the session with those saved with it. All are loaded first, with one settlement pool, and
+then share their plans again: a plan is listed as shared with the first simulation that has
+it, which keeps its own, so the order they share in does not matter.
+*/
+Simulation Journal::loadCheckpoint(const string &checkpointPath) {
+    delete backup;
+    backup = nullptr;
+    for (Checkpoints::Checkpoint &saved : checkpoints.checkpoints) {
+        delete saved.simulation;
+    }
+    checkpoints.checkpoints.clear();
+    checkpoints.current.clear();
+    checkpoints.backupParent.clear();
+    std::unordered_map<string, std::shared_ptr<Settlement>> settlementPool;
+    Simulation simulation = Snapshot::load(checkpointPath, settlementPool);
+    vector<Simulation*> simulations;  // in the order the manifest lists them
+    vector<vector<string>> sharedPlans;  // of each, as its shared lines list them
+    std::ifstream file(checkpointPath + ".backups");
+    string line;
+    while (std::getline(file, line)) {
+        std::istringstream words(line);
+        string kind, name, parent;
+        words >> kind >> name >> parent;
+        if (kind == "shared" && !sharedPlans.empty()) {
+            sharedPlans.back().push_back(line.substr(kind.size()));
+            continue;
+        }
+        if (kind == "backup" && backup == nullptr) {
+            backup = new Simulation(Snapshot::load(checkpointPath + ".backup", settlementPool));
+            checkpoints.backupParent = name;
+            simulations.push_back(backup);
+        } else if (kind == "checkpoint" && !name.empty()) {
+            const string savedPath = checkpointPath + ".checkpoint" + std::to_string(checkpoints.checkpoints.size());
+            checkpoints.checkpoints.push_back(Checkpoints::Checkpoint(name, parent, new Simulation(Snapshot::load(savedPath, settlementPool))));
+            simulations.push_back(checkpoints.checkpoints.back().simulation);
+        } else if (kind == "current") {
+            checkpoints.current = name;
+            simulations.push_back(&simulation);
+        } else {
+            throw std::runtime_error("Invalid journal checkpoint");
+        }
+        sharedPlans.push_back(vector<string>());
+    }
+    for (size_t index = 0; index < simulations.size(); index++) {
+        for (const string &shared : sharedPlans[index]) {
+            std::istringstream ranges(shared);
+            size_t owner = 0;
+            if (!(ranges >> owner) || owner >= index) {
+                throw std::runtime_error("Invalid journal checkpoint");
+            }
+            sharePlans(*simulations[index], *simulations[owner], ranges);
+        }
+    }
+    return simulation;
+}
+
+/*
+The plans of simulations[index] that one listed before it has at the same index, as a line
+"shared <owner> <first>-<last> ..." per owner: the first of them to have the plan, as owners
+records while the simulations are listed in order.
+*/
+string Journal::getSharedPlans(const vector<const Simulation*> &simulations, size_t index, std::unordered_map<const Plan*, size_t> &owners) {
+    const SharedChunkList<CopyOnWrite<Plan>> &planTable = simulations[index]->plans;
+    std::map<size_t, string> ranges;
+    size_t planIndex = 0;
+    size_t first = 0;
+    size_t sharedOwner = index;  // of the plans from first on
+    while (planIndex <= planTable.size()) {
+        size_t owner = index;
+        if (planIndex < planTable.size()) {
+            owner = owners.insert(std::make_pair(&planTable[planIndex].get(), index)).first->second;
+            const SharedChunkList<CopyOnWrite<Plan>> &ownerTable = simulations[owner]->plans;
+            if (owner != index && (planIndex >= ownerTable.size() || !ownerTable[planIndex].sharesWith(planTable[planIndex]))) {
+                owner = index;  // a plan moved to another index can't be shared by it
+            }
+        }
+        if (owner != sharedOwner) {
+            if (sharedOwner != index) {
+                ranges[sharedOwner] += " " + std::to_string(first) + "-" + std::to_string(planIndex - 1);
+            }
+            first = planIndex;
+            sharedOwner = owner;
+        }
+        planIndex++;
+    }
+    string lines;
+    for (const std::pair<const size_t, string> &owned : ranges) {
+        lines += "shared " + std::to_string(owned.first) + owned.second + "\n";
+    }
+    return lines;
+}
+
+// Makes the plans of simulation in the ranges getSharedPlans listed the ones of owner again
+void Journal::sharePlans(Simulation &simulation, const Simulation &owner, std::istream &ranges) {
+    SharedChunkList<CopyOnWrite<Plan>> &planTable = simulation.plans;
+    const SharedChunkList<CopyOnWrite<Plan>> &ownerTable = owner.plans;
+    size_t first = 0;
+    size_t last = 0;
+    char dash = '\0';
+    while (ranges >> first >> dash >> last) {
+        if (dash != '-' || first > last || last >= planTable.size() || last >= ownerTable.size()) {
+            throw std::runtime_error("Invalid journal checkpoint");
+        }
+        for (size_t planIndex = first; planIndex <= last; planIndex++) {
+            planTable.edit(planIndex) = ownerTable[planIndex];
+        }
+    }
+}
+
+/*
+Writes an empty journal naming the checkpoint of generation to a temporary file and renames
+it over path; entries are appended to it from then on.
+*/
+void Journal::replace(uint64_t generation) {
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.generation = generation;
+    const string temporary = path + ".tmp";
+    const int created = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (created == -1) {
+        throw std::runtime_error("Cannot create journal " + path);
+    }
+    try {
+        writeAll(created, reinterpret_cast<const char*>(&header), sizeof(Header));
+    } catch (const std::runtime_error&) {
+        ::close(created);
+        throw;
+    }
+    if (::fsync(created) != 0 || ::rename(temporary.c_str(), path.c_str()) != 0) {
+        ::close(created);
+        throw std::runtime_error("Cannot create journal " + path);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (descriptor != -1) {
+            ::close(descriptor);
+        }
+        descriptor = created;
+        dirty = false;
+    }
+    this->generation = generation;
+    numOfEntries = 0;
+    if (!syncer.joinable()) {
+        stopping = false;
+        syncer = std::thread(&Journal::syncLoop, this);
+    }
+    syncDirectory(path);
+}
+
+// The sync thread: fsyncs the journal every SYNC_INTERVAL_MS if it was written to
+void Journal::syncLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(SYNC_INTERVAL_MS));
+        if (dirty.exchange(false)) {
+            ::fdatasync(descriptor);
+        }
+    }
+}
+
+// Reads an entry's payload into record, with its strings interned in strings. False if it is not a valid entry.
+bool Journal::decode(const char *payload, uint32_t size, ActionLog::Record &record, ActionLog &strings) {
+    std::memset(&record, 0, sizeof(record));
+    const unsigned char kind = size == 0 ? 0 : static_cast<unsigned char>(payload[0]) & ~FAILED;
+    if (size == 0 || kind >= ActionLog::NUM_OF_KINDS
+        || (kind != static_cast<unsigned char>(ActionLog::Kind::SAVE) && (payload[0] & FAILED) != 0)) {
+        return false;
+    }
+    record.kind = static_cast<ActionLog::Kind>(kind);
+    record.completed = (payload[0] & FAILED) == 0;
+    uint32_t position = 1;
+    for (int i = 0; i < ActionLog::getNumOfArgs(record.kind); i++) {
+        if (size - position < sizeof(uint32_t)) {
+            return false;
+        }
+        uint32_t value;
+        std::memcpy(&value, payload + position, sizeof(uint32_t));
+        position += sizeof(uint32_t);
+        if (!ActionLog::isStringArg(record.kind, i)) {
+            record.args[i] = static_cast<int32_t>(value);
+        } else if (value == NO_STRING) {
+            record.args[i] = -1;
+        } else {
+            if (size - position < value) {
+                return false;
+            }
+            record.args[i] = strings.intern(string(payload + position, value));
+            position += value;
+        }
+    }
+    if (record.kind == ActionLog::Kind::SETTLEMENT && !Auxiliary::isSettlementType(record.args[1])) {
+        return false;
+    }
+    if (record.kind == ActionLog::Kind::FACILITY && !Auxiliary::isFacilityCategory(record.args[1])) {
+        return false;
+    }
+    return position == size;
+}
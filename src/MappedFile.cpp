@@ -0,0 +1,45 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Constructor
+MappedFile::MappedFile(const string &path, const string &kind) : kind(kind), data(nullptr), size(0) {
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor == -1) {
+        throw std::runtime_error("Unable to open " + kind);
+    }
+    struct stat status;
+    if (::fstat(descriptor, &status) == -1) {
+        ::close(descriptor);
+        throw std::runtime_error("Unable to open " + kind);
+    }
+    size = static_cast<size_t>(status.st_size);
+    if (size == 0) {  // mmap refuses empty mappings
+        ::close(descriptor);
+        return;
+    }
+    void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Unable to open " + kind);
+    }
+    data = static_cast<const char*>(mapping);
+}
+
+// Methods
+const char *MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
+
+// Destructor
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+}
@@ -0,0 +1,96 @@
+#include "OutputWriter.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+OutputWriter output(STDOUT_FILENO);
+OutputWriter errors(STDERR_FILENO);
+
+// Constructor
+OutputWriter::OutputWriter(int descriptor) : buffer(CAPACITY), used(0), descriptor(descriptor) {}
+
+// Destructor
+OutputWriter::~OutputWriter() {
+    flush();
+}
+
+// Methods
+OutputWriter &OutputWriter::operator<<(const string &text) {
+    write(text.data(), text.size());
+    return *this;
+}
+
+OutputWriter &OutputWriter::operator<<(const char *text) {
+    write(text, std::strlen(text));
+    return *this;
+}
+
+OutputWriter &OutputWriter::operator<<(int value) {
+    char digits[16];
+    char *end = digits + sizeof(digits);
+    char *begin = end;
+    unsigned int magnitude = value < 0 ? 0u - static_cast<unsigned int>(value) : static_cast<unsigned int>(value);
+    do {
+        *--begin = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        *--begin = '-';
+    }
+    write(begin, end - begin);
+    return *this;
+}
+
+OutputWriter &OutputWriter::operator<<(size_t value) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *begin = end;
+    do {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    write(begin, end - begin);
+    return *this;
+}
+
+// For a write that does not fit in what is left of the buffer
+void OutputWriter::writeLarge(const char *data, size_t length) {
+    flush();
+    if (length >= CAPACITY) {
+        writeAll(data, length);
+        return;
+    }
+    std::memcpy(buffer.data(), data, length);
+    used = length;
+}
+
+void OutputWriter::flush() {
+    writeAll(buffer.data(), used);
+    used = 0;
+}
+
+// Writes what is buffered, then sends what follows to descriptor. Returns the previous one.
+int OutputWriter::setDescriptor(int descriptor) {
+    flush();
+    const int previous = this->descriptor;
+    this->descriptor = descriptor;
+    return previous;
+}
+
+// Output that cannot be written (a closed pipe) is dropped, as std::cout would
+void OutputWriter::writeAll(const char *data, size_t length) {
+    if (descriptor == DISCARD) {
+        return;
+    }
+    while (length > 0) {
+        const ssize_t written = ::write(descriptor, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
@@ -1,54 +1,27 @@
 #include "Plan.h"
+#include "OutputWriter.h"
 #include <iostream>
+#include <utility>
 
 // Constructor
-Plan::Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const vector<FacilityType> &facilityOptions)
-    : plan_id(planId), settlement(settlement), selectionPolicy(selectionPolicy),status(PlanStatus::AVALIABLE),facilities(),underConstruction(), facilityOptions(facilityOptions), life_quality_score(0), economy_score(0), environment_score(0) {
+Plan::Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy)
+    : plan_id(planId), settlement(settlement), selectionPolicy(selectionPolicy),status(PlanStatus::AVALIABLE),facilities(),underConstruction(), life_quality_score(0), economy_score(0), environment_score(0) {
         if (selectionPolicy == nullptr) {
         throw std::runtime_error("Selection policy is null");
     }
 }
 
-Plan::Plan(const Plan& other, const Settlement &otherSettlement, const vector<FacilityType> otherFacilityOptions): plan_id(other.plan_id), settlement(otherSettlement), selectionPolicy(other.selectionPolicy -> clone()),status(other.status),facilities(),underConstruction(), facilityOptions(otherFacilityOptions), life_quality_score(other.life_quality_score), economy_score(other.economy_score), environment_score(other.environment_score) {
-    for (Facility* facility : other.facilities) {
-        facilities.push_back(new Facility(*facility));
-    }
-    for (Facility* facility : other.underConstruction) {
-        underConstruction.push_back(new Facility(*facility));
-    }
-}
-
-// Copy constructor 
-Plan::Plan(const Plan& other): plan_id(other.plan_id), settlement(other.settlement), selectionPolicy(other.selectionPolicy -> clone()),status(other.status),facilities(),underConstruction(), facilityOptions(other.facilityOptions), life_quality_score(other.life_quality_score), economy_score(other.economy_score), environment_score(other.environment_score) {
-    for (Facility* facility : other.facilities) {
-        facilities.push_back(new Facility(*facility));
-    }
-    for (Facility* facility : other.underConstruction) {
-        underConstruction.push_back(new Facility(*facility));
-    }
-}
+// Copy constructor, the facilities are shared with other
+Plan::Plan(const Plan& other): plan_id(other.plan_id), settlement(other.settlement), selectionPolicy(other.selectionPolicy -> clone()),status(other.status),facilities(other.facilities),underConstruction(other.underConstruction), life_quality_score(other.life_quality_score), economy_score(other.economy_score), environment_score(other.environment_score) {}
 
 // Destructor
 Plan::~Plan() {
     delete selectionPolicy;
-    for (size_t i = 0; i < facilities.size(); i++) {
-        delete facilities.at(i);
-    }
-    for (size_t i = 0; i < underConstruction.size(); i++) {
-        delete underConstruction.at(i);
-    }
 }
 
 // Move constructor
-Plan::Plan(Plan&& other) noexcept : plan_id(other.plan_id), settlement(other.settlement), selectionPolicy(other.selectionPolicy),status(other.status),facilities(),underConstruction(), facilityOptions(other.facilityOptions), life_quality_score(other.life_quality_score), economy_score(other.economy_score), environment_score(other.environment_score) {
-    for(size_t i = 0; i < other.facilities.size(); i++){
-        facilities.push_back(other.facilities.at(i));
-        other.facilities.at(i) = nullptr;
-    }
-    for (size_t i = 0; i < other.underConstruction.size(); i++) {
-        underConstruction.push_back(other.underConstruction.at(i));
-        other.underConstruction.at(i) = nullptr;
-    }
+Plan::Plan(Plan&& other) noexcept : plan_id(other.plan_id), settlement(other.settlement), selectionPolicy(other.selectionPolicy),status(other.status),facilities(std::move(other.facilities)),underConstruction(other.underConstruction), life_quality_score(other.life_quality_score), economy_score(other.economy_score), environment_score(other.environment_score) {
+    other.facilities.clear();
     other.selectionPolicy = nullptr;
 }
 
@@ -82,6 +55,10 @@ const SelectionPolicy* Plan::getSelectionPolicy() const {
     return selectionPolicy;
 }
 
+SelectionPolicy* Plan::getSelectionPolicy() {
+    return selectionPolicy;
+}
+
 void Plan::setSelectionPolicy(SelectionPolicy *newSelectionPolicy) {
     if (newSelectionPolicy == nullptr) {
         throw std::runtime_error("Selection policy is null");
@@ -92,51 +69,169 @@ void Plan::setSelectionPolicy(SelectionPolicy *newSelectionPolicy) {
     selectionPolicy = newSelectionPolicy;
 }
 
-void Plan::step() {
-    if (status == PlanStatus::AVALIABLE) {
-        int to_build = settlement.constructionLimit() - underConstruction.size();
-        for(int i = 0; i < to_build; i++){
-            FacilityType facility1 = selectionPolicy->selectFacility(facilityOptions);
-            Facility* facility = new Facility(facility1.getName(), settlement.getName(), facility1.getCategory(), facility1.getCost(), facility1.getLifeQualityScore(), facility1.getEconomyScore(), facility1.getEnvironmentScore());
-            underConstruction.push_back(facility);
-            }
+/*
+A step of a plan is split in two so the simulation only visits plans that have work:
+startConstruction fills the free slots of an available plan, and completeConstruction
+turns the facilities finishing in this tick into operational ones.
+Both only touch this plan, so different plans can be stepped on different threads.
+*/
+
+// Number of facilities startConstruction would start in this tick
+int Plan::getFreeSlots() const {
+    if (status != PlanStatus::AVALIABLE) {
+        return 0;
     }
-    for(size_t i = 0; i < underConstruction.size(); i++){
-        if (underConstruction[i]->step() == FacilityStatus::OPERATIONAL){
-            facilities.push_back(underConstruction[i]);
-            underConstruction.erase(underConstruction.begin() + i);
-            life_quality_score += facilities[i]->getLifeQualityScore();
-            economy_score += facilities[i]->getEconomyScore();
-            environment_score += facilities[i]->getEnvironmentScore();
-            }
+    return settlement.constructionLimit() - underConstruction.size();
+}
+
+// Returns the number of facilities started, they are the last slots of the construction queue
+int Plan::startConstruction(const int tick, const FacilityCatalog &facilityOptions) {
+    const int to_build = getFreeSlots();
+    if (to_build == 0) {
+        return 0;
     }
-    if (underConstruction.size() == static_cast<size_t>(settlement.constructionLimit())) {
+    int selected[Settlement::MAX_CONSTRUCTION_LIMIT];
+    selectionPolicy->selectFacilities(facilityOptions, selected, to_build);
+    return startConstruction(tick, facilityOptions, selected);
+}
+
+// Same, with the picks of the selection policy already made (see BalancedBatch)
+int Plan::startConstruction(const int tick, const FacilityCatalog &facilityOptions, const int *selected) {
+    const int to_build = getFreeSlots();
+    for(int i = 0; i < to_build; i++){
+        underConstruction.push(facilityOptions[selected[i]], selected[i], tick);
+    }
+    return to_build;
+}
+
+// Returns true if the plan is available for the next tick
+bool Plan::completeConstruction(const int tick) {
+    int completedTypeIds[Settlement::MAX_CONSTRUCTION_LIMIT];
+    int completed = underConstruction.complete(tick, completedTypeIds, life_quality_score, economy_score, environment_score);
+    for (int i = 0; i < completed; i++) {
+        facilities.push_back(Facility(completedTypeIds[i], settlement));
+    }
+    if (underConstruction.size() == settlement.constructionLimit()) {
         status = PlanStatus::BUSY;
     }
     else {
         status = PlanStatus::AVALIABLE;
     }
+    return status == PlanStatus::AVALIABLE;
+}
+
+/*
+Simulates numOfSteps ticks of this plan alone, starting after the given tick, visiting only
+the ticks in which it starts or finishes something.
+Once the plan state (status, policy cycle state and the time left of each slot) repeats,
+the plan is periodic from there on: whole periods are applied at once by adding their
+score and policy deltas and repeating the facilities they built, as one counted run of
+the list, and only the remainder is simulated. The result is the same as stepping tick by tick.
+A repeat is found with Brent's method: the state is compared with one saved state, which is
+replaced by the current one after 1, 2, 4, ... visits, so finding a cycle costs one compare
+per visit and no state is kept but the saved one. The search stops halfway through the run,
+as past that a period saves less than finding it costs.
+*/
+void Plan::fastForward(const int tick, const int numOfSteps, const FacilityCatalog &facilityOptions) {
+    struct CycleRecord {
+        int tick;
+        int lifeQualityScore, economyScore, environmentScore;
+        size_t facilities;
+        long long policyOffset;
+    };
+    vector<int> savedState;
+    vector<int> state;
+    CycleRecord start = {0, 0, 0, 0, 0, 0};
+    size_t power = 0;  // visits between saving the state; 0 until it is first saved
+    size_t sinceSaved = 0;
+    bool lookForCycle = true;
+    const int endTick = tick + numOfSteps;
+    const int searchEndTick = tick + numOfSteps / 2;
+    int current = tick;
+    while (current < endTick) {
+        const int next = (status == PlanStatus::AVALIABLE ? current + 1 : underConstruction.nextFinishTick(current));
+        if (next == -1 || next > endTick) {
+            break;
+        }
+        current = next;
+        startConstruction(current, facilityOptions);
+        completeConstruction(current);
+        if (!lookForCycle) {
+            continue;
+        }
+        if (current > searchEndTick) {
+            lookForCycle = false;
+            continue;
+        }
+        state.clear();
+        getCycleState(current, state);
+        if (power == 0 || state != savedState) {
+            if (sinceSaved == power) {
+                savedState.swap(state);
+                CycleRecord record = {current, life_quality_score, economy_score, environment_score, facilities.size(), selectionPolicy->getCycleOffset()};
+                start = record;
+                power = power == 0 ? 1 : 2 * power;
+                sinceSaved = 0;
+            }
+            sinceSaved++;
+            continue;
+        }
+        const int period = current - start.tick;
+        const int cycles = (endTick - current) / period;
+        life_quality_score = static_cast<int>(life_quality_score + static_cast<long long>(cycles) * (life_quality_score - start.lifeQualityScore));
+        economy_score = static_cast<int>(economy_score + static_cast<long long>(cycles) * (economy_score - start.economyScore));
+        environment_score = static_cast<int>(environment_score + static_cast<long long>(cycles) * (environment_score - start.environmentScore));
+        facilities.repeatTail(start.facilities, cycles);
+        selectionPolicy->addCycleOffset(cycles * (selectionPolicy->getCycleOffset() - start.policyOffset));
+        underConstruction.postpone(current, cycles * period);
+        current += cycles * period;
+        lookForCycle = false;
+    }
+}
+
+// Everything that decides what the plan does next, with finish ticks relative to the given tick
+void Plan::getCycleState(const int tick, vector<int> &state) const {
+    state.push_back(static_cast<int>(status));
+    selectionPolicy->getCycleState(state);
+    for (int slot = 0; slot < underConstruction.size(); slot++) {
+        const int finishTick = underConstruction.getFinishTick(slot);
+        state.push_back(finishTick > tick ? finishTick - tick : -1);
+        state.push_back(underConstruction.getTypeId(slot));
+    }
+}
+
+bool Plan::isAvailable() const {
+    return status == PlanStatus::AVALIABLE;
 }
 
 void Plan::printStatus() {
-    std::cout << (status == PlanStatus::AVALIABLE ? "AVALIABLE" : "BUSY") << std::endl;
+    output << (status == PlanStatus::AVALIABLE ? "AVALIABLE" : "BUSY") << '\n';
 }
 
-const vector<Facility*> &Plan::getFacilities() const {
+const RunList<Facility> &Plan::getFacilities() const {
     return facilities;
 }
 
-const vector<Facility*> &Plan::getUnderConstruction() const {
+const ConstructionQueue &Plan::getUnderConstruction() const {
     return underConstruction;
 }
 
-void Plan::addFacility(Facility* facility) {
-    if (facility == nullptr) {
-        throw std::runtime_error("Facility is null");
-    }
+void Plan::addFacility(const Facility &facility) {
     facilities.push_back(facility);
 }
 
+void Plan::resumeConstruction(const FacilityType &type, const int typeId, const int finishTick) {
+    underConstruction.resume(type, typeId, finishTick);
+}
+
+// Sets the status and scores of a plan read back from a snapshot
+void Plan::restore(const bool available, const int lifeQualityScore, const int economyScore, const int environmentScore) {
+    status = (available ? PlanStatus::AVALIABLE : PlanStatus::BUSY);
+    life_quality_score = lifeQualityScore;
+    economy_score = economyScore;
+    environment_score = environmentScore;
+}
+
 const string Plan::toString() const {
     return "Plan ID: " + std::to_string(plan_id) + ", Status: " + (status == PlanStatus::AVALIABLE ? "Available" : "Busy");
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "Replay.h"
+#include "Auxiliary.h"
+#include "Journal.h"
+#include "MappedFile.h"
+#include "OutputWriter.h"
+#include <chrono>
+#include <cstring>
+#include <vector>
+using std::vector;
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Methods
+// Runs the commands of a text recording on the simulation, until close or the end of the recording
+void Replay::replayText(const string &recordingPath, Simulation &simulation, Result &result) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    result.numOfActions = simulation.runScript(recordingPath);
+    result.seconds = secondsSince(start);
+}
+
+// The simulation a journal rebuilds; the time includes loading its checkpoint
+Simulation Replay::replayJournal(const string &journalPath, const int numOfThreads, Result &result) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Journal::Replayed replayed;
+    Simulation simulation = Journal::replay(journalPath, numOfThreads, replayed);
+    output.flush();
+    result.numOfActions = replayed.numOfEntries;
+    result.seconds = secondsSince(start);
+    return simulation;
+}
+
+/*
+Checks the scores of the simulation's plans against the output the recorded session printed,
+the text report of close at its end: for every plan, the scores last printed under its PlanID
+(by close, or by its last planStatus if close never ran). Prints each difference, and returns
+how many plans differ, are missing from the simulation, or were never printed.
+*/
+int Replay::verify(const string &recordedOutputPath, const Simulation &simulation) {
+    vector<Scores> recorded;
+    {
+        MappedFile file(recordedOutputPath, "recorded output");
+        vector<Argument> arguments;
+        int planId = -1;
+        const char *position = file.getData();
+        const char *end = position + file.getSize();
+        while (position != end) {
+            const char *lineEnd = static_cast<const char*>(std::memchr(position, '\n', end - position));
+            if (lineEnd == nullptr) {
+                lineEnd = end;
+            }
+            Auxiliary::splitArguments(position, lineEnd, arguments);
+            position = lineEnd == end ? end : lineEnd + 1;
+            int value = 0;
+            if (arguments.size() != 2 || !Auxiliary::parseInt(arguments[1], value)) {
+                continue;
+            }
+            if (arguments[0] == "PlanID:") {
+                planId = value < 0 ? -1 : value;
+                if (planId != -1 && static_cast<size_t>(planId) >= recorded.size()) {
+                    recorded.resize(planId + 1);
+                }
+            } else if (planId == -1) {
+                continue;
+            } else if (arguments[0] == "LifeQualityScore:") {
+                recorded[planId].recorded = true;
+                recorded[planId].lifeQuality = value;
+            } else if (arguments[0] == "EconomyScore:") {
+                recorded[planId].economy = value;
+            } else if (arguments[0] == "EnvironmentScore:") {
+                recorded[planId].environment = value;
+            }
+        }
+    }
+
+    int numOfDifferences = 0;
+    for (int planId = 0; static_cast<size_t>(planId) < recorded.size() || simulation.planExists(planId); planId++) {
+        const bool inRecording = static_cast<size_t>(planId) < recorded.size() && recorded[planId].recorded;
+        if (!simulation.planExists(planId)) {
+            if (inRecording) {
+                output << "Plan " << planId << " is not in the simulation" << '\n';
+                numOfDifferences++;
+            }
+            continue;
+        }
+        if (!inRecording) {
+            output << "Plan " << planId << " is not in the recorded output" << '\n';
+            numOfDifferences++;
+            continue;
+        }
+        const Plan &plan = simulation.getPlan(planId);
+        const Scores &scores = recorded[planId];
+        if (plan.getlifeQualityScore() != scores.lifeQuality || plan.getEconomyScore() != scores.economy
+            || plan.getEnvironmentScore() != scores.environment) {
+            output << "Plan " << planId << " scores " << plan.getlifeQualityScore() << ' '
+                   << plan.getEconomyScore() << ' ' << plan.getEnvironmentScore() << ", recorded "
+                   << scores.lifeQuality << ' ' << scores.economy << ' ' << scores.environment << '\n';
+            numOfDifferences++;
+        }
+    }
+    return numOfDifferences;
+}
@@ -0,0 +1,229 @@
+#include "ReportFormatter.h"
+#include <cstdio>
+#include <cstring>
+
+ReportFormatter report(output);
+
+// Constructor
+ReportFormatter::ReportFormatter(OutputWriter &writer) : writer(writer), format(ReportFormat::TEXT), depth(0), firstField(),
+    row(), list(), columns(), header() {}
+
+// Methods
+void ReportFormatter::setFormat(ReportFormat format) {
+    this->format = format;
+}
+
+ReportFormat ReportFormatter::getFormat() const {
+    return format;
+}
+
+// "text", "csv" or "json"; returns false for anything else
+bool ReportFormatter::parseFormat(const string &name, ReportFormat &format) {
+    if (name == "text") {
+        format = ReportFormat::TEXT;
+    } else if (name == "csv") {
+        format = ReportFormat::CSV;
+    } else if (name == "json") {
+        format = ReportFormat::JSON_LINES;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void ReportFormatter::beginRecord() {
+    if (format == ReportFormat::JSON_LINES) {
+        if (depth > 0) {
+            separate(nullptr);
+        }
+        writer << '{';
+    }
+    if (format == ReportFormat::CSV && depth > 1) {
+        if (!firstField[depth - 1]) {
+            put(';');
+        }
+        firstField[depth - 1] = false;
+    }
+    push();
+}
+
+void ReportFormatter::endRecord() {
+    pop();
+    if (format == ReportFormat::JSON_LINES) {
+        writer << '}';
+    }
+    if (depth > 0 || format == ReportFormat::TEXT) {
+        return;
+    }
+    if (format == ReportFormat::CSV) {
+        if (columns != header) {
+            writer << columns << '\n';
+            header = columns;
+        }
+        writer << row;
+        row.clear();
+        columns.clear();
+    }
+    writer << '\n';
+}
+
+void ReportFormatter::beginList(const char *name) {
+    if (format != ReportFormat::TEXT) {
+        separate(name);
+    }
+    if (format == ReportFormat::JSON_LINES) {
+        writer << '[';
+    }
+    push();
+}
+
+void ReportFormatter::endList() {
+    pop();
+    if (format == ReportFormat::JSON_LINES) {
+        writer << ']';
+    }
+    if (format == ReportFormat::CSV && depth == 1) {
+        putQuoted(list.data(), list.size());
+        list.clear();
+    }
+}
+
+void ReportFormatter::field(const char *name, int value) {
+    separate(name);
+    put(value);
+    if (format == ReportFormat::TEXT) {
+        writer << '\n';
+    }
+}
+
+void ReportFormatter::field(const char *name, const char *value) {
+    separate(name);
+    writeString(value, std::strlen(value));
+    if (format == ReportFormat::TEXT) {
+        writer << '\n';
+    }
+}
+
+void ReportFormatter::field(const char *name, const string &value) {
+    separate(name);
+    writeString(value.data(), value.size());
+    if (format == ReportFormat::TEXT) {
+        writer << '\n';
+    }
+}
+
+void ReportFormatter::push() {
+    firstField[depth] = true;
+    depth++;
+}
+
+void ReportFormatter::pop() {
+    depth--;
+}
+
+// Writes what comes before a value: its name, and the separator from the value before it
+void ReportFormatter::separate(const char *name) {
+    if (format == ReportFormat::TEXT) {
+        writer << name << ": ";
+        return;
+    }
+    if (format == ReportFormat::CSV && depth == 1) {
+        addColumn(name);
+    }
+    if (!firstField[depth - 1]) {
+        put(format == ReportFormat::CSV && depth > 1 ? ':' : ',');
+    }
+    firstField[depth - 1] = false;
+    if (format == ReportFormat::JSON_LINES && name != nullptr) {
+        writer << '"' << name << "\":";
+    }
+}
+
+// Quotes and escapes for CSV and JSON only where needed; settlement and facility names
+// come from whitespace separated input, so this is the rare path.
+void ReportFormatter::writeString(const char *value, size_t length) {
+    if (format == ReportFormat::TEXT) {
+        writer.write(value, length);
+        return;
+    }
+    if (format == ReportFormat::CSV && depth > 1) {
+        for (size_t i = 0; i < length; i++) {
+            if (value[i] == ':' || value[i] == ';' || value[i] == '\\') {
+                put('\\');
+            }
+            put(value[i]);
+        }
+        return;
+    }
+    if (format == ReportFormat::CSV) {
+        bool quoted = false;
+        for (size_t i = 0; i < length && !quoted; i++) {
+            quoted = (value[i] == ',' || value[i] == '"' || value[i] == '\r' || value[i] == '\n');
+        }
+        if (quoted) {
+            putQuoted(value, length);
+        } else {
+            put(value, length);
+        }
+        return;
+    }
+    writer << '"';
+    for (size_t i = 0; i < length; i++) {
+        const unsigned char character = static_cast<unsigned char>(value[i]);
+        if (character == '"' || character == '\\') {
+            writer << '\\' << value[i];
+        } else if (character < 0x20) {
+            static const char HEX[] = "0123456789abcdef";
+            writer << "\\u00" << HEX[character >> 4] << HEX[character & 0xf];
+        } else {
+            writer << value[i];
+        }
+    }
+    writer << '"';
+}
+
+void ReportFormatter::putQuoted(const char *value, size_t length) {
+    put('"');
+    for (size_t i = 0; i < length; i++) {
+        if (value[i] == '"') {
+            put('"');
+        }
+        put(value[i]);
+    }
+    put('"');
+}
+
+// CSV values go to the row, or the list in it, everything else straight to the writer
+void ReportFormatter::put(char character) {
+    if (format == ReportFormat::CSV) {
+        (depth > 1 ? list : row) += character;
+    } else {
+        writer << character;
+    }
+}
+
+void ReportFormatter::put(const char *text, size_t length) {
+    if (format == ReportFormat::CSV) {
+        (depth > 1 ? list : row).append(text, length);
+    } else {
+        writer.write(text, length);
+    }
+}
+
+void ReportFormatter::put(int value) {
+    if (format != ReportFormat::CSV) {
+        writer << value;
+        return;
+    }
+    char digits[16];
+    const int length = std::snprintf(digits, sizeof(digits), "%d", value);
+    (depth > 1 ? list : row).append(digits, length);
+}
+
+// The row and header keep their capacity, so after the first records nothing is allocated
+void ReportFormatter::addColumn(const char *name) {
+    if (!columns.empty()) {
+        columns += ',';
+    }
+    columns += name;
+}
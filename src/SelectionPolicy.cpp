@@ -1,15 +1,99 @@
 #include <iostream>
 #include "SelectionPolicy.h"
 #include "Facility.h"
+#include "BalancedKernel.h"
 #include <string>
 #include <limits>
+#include <algorithm>
+#include <cstring>
+
+
+static SelectionPolicy *createNaive() {
+    return new NaiveSelection();
+}
+
+static SelectionPolicy *createBalanced() {
+    return new BalancedSelection(0, 0, 0);
+}
+
+static SelectionPolicy *createEconomy() {
+    return new EconomySelection();
+}
+
+static SelectionPolicy *createSustainability() {
+    return new SustainabilitySelection();
+}
+
+struct PolicyEntry {
+    const char *name;
+    SelectionPolicy *(*create)();
+};
+
+/*
+The policies, each at the slot of policyHash(name). The hash is perfect for these names and
+also puts each at its id, so finding a policy is one hash and one compare. A new policy goes
+at the slot its name hashes to, with a larger table and another hash if that slot is taken;
+the static_assert below fails the build if any entry is out of place.
+*/
+static constexpr PolicyEntry POLICIES[SelectionPolicy::NUM_OF_POLICIES] = {
+    {"nve", createNaive},
+    {"bal", createBalanced},
+    {"eco", createEconomy},
+    {"env", createSustainability}
+};
+
+static constexpr int policyHash(const char *name, size_t length) {
+    return length < 2 ? 0 : (static_cast<unsigned char>(name[0]) + 3 * static_cast<unsigned char>(name[1])) % SelectionPolicy::NUM_OF_POLICIES;
+}
+
+static constexpr size_t nameLength(const char *name) {
+    return *name == '\0' ? 0 : 1 + nameLength(name + 1);
+}
+
+static constexpr bool policiesInPlace(int slot) {
+    return slot == SelectionPolicy::NUM_OF_POLICIES
+        || (policyHash(POLICIES[slot].name, nameLength(POLICIES[slot].name)) == slot && policiesInPlace(slot + 1));
+}
+
+static_assert(policiesInPlace(0), "A policy is not at the slot its name hashes to");
+
+// SelectionPolicy implementation
+int SelectionPolicy::findPolicy(const char *name, size_t length) {
+    const int slot = policyHash(name, length);
+    const char *candidate = POLICIES[slot].name;
+    return std::strncmp(candidate, name, length) == 0 && candidate[length] == '\0' ? slot : -1;
+}
+
+int SelectionPolicy::findPolicy(const string &name) {
+    return findPolicy(name.data(), name.size());
+}
+
+const char *SelectionPolicy::getPolicyName(int policy) {
+    return POLICIES[policy].name;
+}
+
+SelectionPolicy *SelectionPolicy::create(int policy) {
+    return POLICIES[policy].create();
+}
+
+void SelectionPolicy::selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots) {
+    for (int i = 0; i < numOfSlots; i++) {
+        selected[i] = static_cast<int>(&selectFacility(facilitiesOptions) - facilitiesOptions.getFacilities().data());
+    }
+}
+
+long long SelectionPolicy::getCycleOffset() const {
+    return 0;
+}
+
+void SelectionPolicy::addCycleOffset(long long offset) {}
 
 
 // NaiveSelection implementation
 NaiveSelection::NaiveSelection() : lastSelectedIndex(0) {}
 
 // Methods
-const FacilityType& NaiveSelection::selectFacility(const vector<FacilityType>& facilitiesOptions) {
+const FacilityType& NaiveSelection::selectFacility(const FacilityCatalog& facilitiesOptions) {
     if (!facilitiesOptions.empty()) {
         if (lastSelectedIndex >= facilitiesOptions.size()) {
             lastSelectedIndex = 0;
@@ -19,6 +103,18 @@ const FacilityType& NaiveSelection::selectFacility(const vector<FacilityType>& f
     throw std::runtime_error("No facilities available.");
 }
 
+void NaiveSelection::selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots) {
+    if (facilitiesOptions.empty()) {
+        throw std::runtime_error("No facilities available.");
+    }
+    for (int i = 0; i < numOfSlots; i++) {
+        if (lastSelectedIndex >= facilitiesOptions.size()) {
+            lastSelectedIndex = 0;
+        }
+        selected[i] = static_cast<int>(lastSelectedIndex++);
+    }
+}
+
 const string NaiveSelection::toString() const {
     return "nve";
 }
@@ -27,29 +123,26 @@ NaiveSelection* NaiveSelection::clone() const {
     return new NaiveSelection(*this);
 }
 
+void NaiveSelection::getCycleState(vector<int> &state) const {
+    state.push_back(static_cast<int>(lastSelectedIndex));
+}
+
+void NaiveSelection::getState(int *state) const {
+    state[0] = static_cast<int>(lastSelectedIndex);
+}
+
+void NaiveSelection::setState(const int *state) {
+    lastSelectedIndex = static_cast<size_t>(state[0]);
+}
+
 
 // BalancedSelection implementation
 BalancedSelection::BalancedSelection(int lifeQualityScore, int economyScore, int environmentScore)
     : LifeQualityScore(lifeQualityScore), EconomyScore(economyScore), EnvironmentScore(environmentScore) {}
 
-const FacilityType& BalancedSelection::selectFacility(const vector<FacilityType>& facilitiesOptions) {
+const FacilityType& BalancedSelection::selectFacility(const FacilityCatalog& facilitiesOptions) {
     if (!facilitiesOptions.empty()) {
-        int smallestDistanceIndex = 0;
-        int distance = std::numeric_limits<int>::max();
-
-        for (size_t i = 0; i < facilitiesOptions.size(); i++) {
-            int lifeQuality = facilitiesOptions[i].getLifeQualityScore() + LifeQualityScore;
-            int economy = facilitiesOptions[i].getEconomyScore() + EconomyScore;
-            int environment = facilitiesOptions[i].getEnvironmentScore() + EnvironmentScore;
-
-            int maxScore = std::max(lifeQuality, std::max(economy, environment));
-            int minScore = std::min(lifeQuality, std::min(economy, environment));
-
-            if (maxScore - minScore < distance) {
-                distance = maxScore - minScore;
-                smallestDistanceIndex = i;
-            }
-        }
+        size_t smallestDistanceIndex = BalancedKernel::argmin(facilitiesOptions.getLifeQualityScores(), facilitiesOptions.getEconomyScores(), facilitiesOptions.getEnvironmentScores(), facilitiesOptions.size(), LifeQualityScore, EconomyScore, EnvironmentScore);
         LifeQualityScore += facilitiesOptions[smallestDistanceIndex].getLifeQualityScore();
         EconomyScore += facilitiesOptions[smallestDistanceIndex].getEconomyScore();
         EnvironmentScore += facilitiesOptions[smallestDistanceIndex].getEnvironmentScore();
@@ -59,6 +152,40 @@ const FacilityType& BalancedSelection::selectFacility(const vector<FacilityType>
     }
 }
 
+// Every pick moves the totals the next one is measured from, so the catalog is searched once per slot
+void BalancedSelection::selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots) {
+    if (facilitiesOptions.empty()) {
+        throw std::invalid_argument("No facilities available.");
+    }
+    const int *lifeQualityScores = facilitiesOptions.getLifeQualityScores();
+    const int *economyScores = facilitiesOptions.getEconomyScores();
+    const int *environmentScores = facilitiesOptions.getEnvironmentScores();
+    for (int i = 0; i < numOfSlots; i++) {
+        const size_t index = BalancedKernel::argmin(lifeQualityScores, economyScores, environmentScores, facilitiesOptions.size(), LifeQualityScore, EconomyScore, EnvironmentScore);
+        addSelection(facilitiesOptions, index);
+        selected[i] = static_cast<int>(index);
+    }
+}
+
+int BalancedSelection::getLifeQualityScore() const {
+    return LifeQualityScore;
+}
+
+int BalancedSelection::getEconomyScore() const {
+    return EconomyScore;
+}
+
+int BalancedSelection::getEnvironmentScore() const {
+    return EnvironmentScore;
+}
+
+// Adds a pick made outside of selectFacility, by a BalancedBatch
+void BalancedSelection::addSelection(const FacilityCatalog& facilitiesOptions, size_t index) {
+    LifeQualityScore += facilitiesOptions.getLifeQualityScores()[index];
+    EconomyScore += facilitiesOptions.getEconomyScores()[index];
+    EnvironmentScore += facilitiesOptions.getEnvironmentScores()[index];
+}
+
 const string BalancedSelection::toString() const {
     return "bal";
 }
@@ -67,27 +194,63 @@ BalancedSelection* BalancedSelection::clone() const {
     return new BalancedSelection(*this);
 }
 
+// Distances only depend on how far apart the scores are, so they are kept relative to the smallest one
+void BalancedSelection::getCycleState(vector<int> &state) const {
+    const long long offset = getCycleOffset();
+    state.push_back(static_cast<int>(LifeQualityScore - offset));
+    state.push_back(static_cast<int>(EconomyScore - offset));
+    state.push_back(static_cast<int>(EnvironmentScore - offset));
+}
+
+void BalancedSelection::getState(int *state) const {
+    state[0] = LifeQualityScore;
+    state[1] = EconomyScore;
+    state[2] = EnvironmentScore;
+}
+
+void BalancedSelection::setState(const int *state) {
+    LifeQualityScore = state[0];
+    EconomyScore = state[1];
+    EnvironmentScore = state[2];
+}
+
+long long BalancedSelection::getCycleOffset() const {
+    return std::min(LifeQualityScore, std::min(EconomyScore, EnvironmentScore));
+}
+
+void BalancedSelection::addCycleOffset(long long offset) {
+    LifeQualityScore = static_cast<int>(LifeQualityScore + offset);
+    EconomyScore = static_cast<int>(EconomyScore + offset);
+    EnvironmentScore = static_cast<int>(EnvironmentScore + offset);
+}
+
 
 // EconomySelection implementation
 EconomySelection::EconomySelection() : lastSelectedIndex(0) {}
 
-const FacilityType& EconomySelection::selectFacility(const vector<FacilityType>& facilitiesOptions) {
-    if (lastSelectedIndex >= facilitiesOptions.size()) {
+// Round robin over the ECONOMY facilities, in catalog order
+const FacilityType& EconomySelection::selectFacility(const FacilityCatalog& facilitiesOptions) {
+    const vector<int> &economyFacilities = facilitiesOptions.getCategoryIndices(FacilityCategory::ECONOMY);
+    if (economyFacilities.empty()) {
+        throw std::runtime_error("No ECONOMY facilities available.");
+    }
+    if (lastSelectedIndex >= economyFacilities.size()) {
         lastSelectedIndex = 0;
     }
-    for (size_t i = static_cast<size_t>(lastSelectedIndex); i < facilitiesOptions.size(); i++) {
-        if (facilitiesOptions[i].getCategory() == FacilityCategory::ECONOMY) {
-            lastSelectedIndex = i + 1;
-            return facilitiesOptions[i];
-        }
+    return facilitiesOptions[economyFacilities[lastSelectedIndex++]];
+}
+
+void EconomySelection::selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots) {
+    const vector<int> &economyFacilities = facilitiesOptions.getCategoryIndices(FacilityCategory::ECONOMY);
+    if (economyFacilities.empty()) {
+        throw std::runtime_error("No ECONOMY facilities available.");
     }
-    for (size_t i = 0; i < static_cast<size_t>(lastSelectedIndex); i++) {
-        if (facilitiesOptions[i].getCategory() == FacilityCategory::ECONOMY) {
-            lastSelectedIndex = i + 1;
-            return facilitiesOptions[i];
+    for (int i = 0; i < numOfSlots; i++) {
+        if (lastSelectedIndex >= economyFacilities.size()) {
+            lastSelectedIndex = 0;
         }
+        selected[i] = economyFacilities[lastSelectedIndex++];
     }
-    throw std::runtime_error("No ECONOMY facilities available.");
 }
 
 const string EconomySelection::toString() const {
@@ -98,27 +261,45 @@ EconomySelection* EconomySelection::clone() const {
     return new EconomySelection(*this);
 }
 
+void EconomySelection::getCycleState(vector<int> &state) const {
+    state.push_back(static_cast<int>(lastSelectedIndex));
+}
+
+void EconomySelection::getState(int *state) const {
+    state[0] = static_cast<int>(lastSelectedIndex);
+}
+
+void EconomySelection::setState(const int *state) {
+    lastSelectedIndex = static_cast<size_t>(state[0]);
+}
+
 
 // SustainabilitySelection implementation
 SustainabilitySelection::SustainabilitySelection() : lastSelectedIndex(0) {}
 
-const FacilityType& SustainabilitySelection::selectFacility(const vector<FacilityType>& facilitiesOptions) {
-    if (lastSelectedIndex >= facilitiesOptions.size()) {
+// Round robin over the ENVIRONMENT facilities, in catalog order
+const FacilityType& SustainabilitySelection::selectFacility(const FacilityCatalog& facilitiesOptions) {
+    const vector<int> &environmentFacilities = facilitiesOptions.getCategoryIndices(FacilityCategory::ENVIRONMENT);
+    if (environmentFacilities.empty()) {
+        throw std::runtime_error("No ENVIRONMENT facilities available.");
+    }
+    if (lastSelectedIndex >= environmentFacilities.size()) {
         lastSelectedIndex = 0;
-        }
-    for (size_t i = lastSelectedIndex; i < facilitiesOptions.size(); i++) {
-        if (facilitiesOptions[i].getCategory() == FacilityCategory::ENVIRONMENT) {
-            lastSelectedIndex = i + 1;
-            return facilitiesOptions[i];
-        }
     }
-    for (size_t i = 0; i < lastSelectedIndex; i++) {
-        if (facilitiesOptions[i].getCategory() == FacilityCategory::ENVIRONMENT) {
-            lastSelectedIndex = i + 1;
-            return facilitiesOptions[i];
+    return facilitiesOptions[environmentFacilities[lastSelectedIndex++]];
+}
+
+void SustainabilitySelection::selectFacilities(const FacilityCatalog& facilitiesOptions, int *selected, int numOfSlots) {
+    const vector<int> &environmentFacilities = facilitiesOptions.getCategoryIndices(FacilityCategory::ENVIRONMENT);
+    if (environmentFacilities.empty()) {
+        throw std::runtime_error("No ENVIRONMENT facilities available.");
+    }
+    for (int i = 0; i < numOfSlots; i++) {
+        if (lastSelectedIndex >= environmentFacilities.size()) {
+            lastSelectedIndex = 0;
         }
+        selected[i] = environmentFacilities[lastSelectedIndex++];
     }
-    throw std::runtime_error("No ENVIRONMENT facilities available.");
 }
 
 const string SustainabilitySelection::toString() const {
@@ -128,3 +309,15 @@ const string SustainabilitySelection::toString() const {
 SustainabilitySelection* SustainabilitySelection::clone() const {
     return new SustainabilitySelection(*this);
 }
+
+void SustainabilitySelection::getCycleState(vector<int> &state) const {
+    state.push_back(static_cast<int>(lastSelectedIndex));
+}
+
+void SustainabilitySelection::getState(int *state) const {
+    state[0] = static_cast<int>(lastSelectedIndex);
+}
+
+void SustainabilitySelection::setState(const int *state) {
+    lastSelectedIndex = static_cast<size_t>(state[0]);
+}
@@ -1,127 +1,239 @@
 #include "Simulation.h"
 #include "Action.h"
+#include "ConfigImage.h"
+#include "ConfigLoader.h"
+#include "Journal.h"
+#include "MappedFile.h"
+#include "OutputWriter.h"
+#include "ReportFormatter.h"
 #include "SelectionPolicy.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
 #include "Auxiliary.h"
 
-Simulation::Simulation(const string &configFilePath) : isRunning(false), planCounter(0),actionsLog(),plans(),settlements(),facilitiesOptions() {
-    // Load configuration from file
-    std::ifstream configFile(configFilePath);
-    if (!configFile.is_open()) {
-        throw std::runtime_error("Unable to open config file");
-    }
-    for (string line; std::getline(configFile, line);) {
-        std::vector<std::string> cur_line = Auxiliary::parseArguments(line);
-        if (cur_line[0] == "settlement") {
-            SettlementType settlementType = static_cast<SettlementType>(std::stoi(cur_line[2]));
-            Settlement *settlement = new Settlement(cur_line[1], settlementType);
-            addSettlement(settlement);
-        }
-        else if (cur_line[0] == "facility") {
-            FacilityType facillity = FacilityType(cur_line[1], static_cast<FacilityCategory>(std::stoi(cur_line[2])), std::stoi(cur_line[3]), std::stoi(cur_line[4]), std::stoi(cur_line[5]), std::stoi(cur_line[6]));
-            addFacility(facillity);
-        }
-        else if (cur_line[0] == "plan") {
-            Settlement &settlement = getSettlement(cur_line[1]);
-            if (cur_line[2] == "bal") {
-                addPlan(settlement, new BalancedSelection(0, 0, 0));
-            } else if (cur_line[2] == "eco") {
-                addPlan(settlement, new EconomySelection());
-            } else if (cur_line[2] == "nve") {
-                addPlan(settlement, new NaiveSelection());
-            } else if (cur_line[2] == "env") {
-                addPlan(settlement, new SustainabilitySelection());
-            } else {
-                throw std::runtime_error("Cannot create this plan");
-            }
-        }else if (cur_line[0] == "#"){
-            continue;
-        }
+// The commands: each parses the arguments of its line into an action and adds it, or returns
+// false if they are missing or malformed
+static bool runStep(const vector<Argument> &arguments, Simulation &simulation) {
+    int numOfSteps = 0;
+    if (!Auxiliary::parseInts(arguments, 1, 1, &numOfSteps)) {
+        return false;
     }
+    simulation.addAction(new SimulateStep(numOfSteps));
+    return true;
 }
 
-// Copy Constructor
-Simulation::Simulation(const Simulation& other)
-    : isRunning(other.isRunning),
-      planCounter(other.planCounter),
-      actionsLog(),
-      plans(),
-      settlements(),
-      facilitiesOptions(other.facilitiesOptions) {
-    for (size_t i = 0; i < other.actionsLog.size(); i++) {
-        actionsLog.push_back(other.actionsLog[i]->clone());
+static bool runPlan(const vector<Argument> &arguments, Simulation &simulation) {
+    if (arguments.size() < 3) {
+        return false;
+    }
+    simulation.addAction(new AddPlan(arguments[1].str(), arguments[2].str()));
+    return true;
+}
+
+static bool runSettlement(const vector<Argument> &arguments, Simulation &simulation) {
+    int type = 0;
+    if (!Auxiliary::parseInts(arguments, 2, 1, &type) || !Auxiliary::isSettlementType(type)) {
+        return false;
+    }
+    simulation.addAction(new AddSettlement(arguments[1].str(), static_cast<SettlementType>(type)));
+    return true;
+}
+
+static bool runFacility(const vector<Argument> &arguments, Simulation &simulation) {
+    int values[5];
+    if (!Auxiliary::parseInts(arguments, 2, 5, values) || !Auxiliary::isFacilityCategory(values[0])) {
+        return false;
     }
-    for (size_t i = 0; i < other.settlements.size(); i++) {
-        settlements.push_back(new Settlement(*other.settlements[i]));
+    simulation.addAction(new AddFacility(arguments[1].str(), static_cast<FacilityCategory>(values[0]), values[1], values[2], values[3], values[4]));
+    return true;
+}
+
+static bool runPlanStatus(const vector<Argument> &arguments, Simulation &simulation) {
+    int planId = 0;
+    if (!Auxiliary::parseInts(arguments, 1, 1, &planId)) {
+        return false;
     }
-    for (Plan plan : other.plans) {
-        plans.emplace_back(plan, getSettlement(plan.getSettlement().getName()), facilitiesOptions);
+    simulation.addAction(new PrintPlanStatus(planId));
+    return true;
+}
+
+static bool runChangePolicy(const vector<Argument> &arguments, Simulation &simulation) {
+    int planId = 0;
+    if (!Auxiliary::parseInts(arguments, 1, 1, &planId) || arguments.size() < 3) {
+        return false;
     }
+    simulation.addAction(new ChangePlanPolicy(planId, arguments[2].str()));
+    return true;
+}
+
+static bool runLog(const vector<Argument> &arguments, Simulation &simulation) {
+    simulation.addAction(new PrintActionsLog());
+    return true;
+}
+
+static bool runClose(const vector<Argument> &arguments, Simulation &simulation) {
+    simulation.addAction(new Close());
+    return true;
+}
+
+static bool runBackup(const vector<Argument> &arguments, Simulation &simulation) {
+    simulation.addAction(arguments.size() > 1 ? new BackupSimulation(arguments[1].str()) : new BackupSimulation());
+    return true;
+}
+
+static bool runRestore(const vector<Argument> &arguments, Simulation &simulation) {
+    simulation.addAction(arguments.size() > 1 ? new RestoreSimulation(arguments[1].str()) : new RestoreSimulation());
+    return true;
+}
+
+static bool runBackups(const vector<Argument> &arguments, Simulation &simulation) {
+    simulation.addAction(new PrintBackups());
+    return true;
 }
 
+static bool runDropBackup(const vector<Argument> &arguments, Simulation &simulation) {
+    if (arguments.size() < 2) {
+        return false;
+    }
+    simulation.addAction(new DropBackup(arguments[1].str()));
+    return true;
+}
+
+static bool runSave(const vector<Argument> &arguments, Simulation &simulation) {
+    if (arguments.size() < 2) {
+        return false;
+    }
+    simulation.addAction(new SaveSimulation(arguments[1].str()));
+    return true;
+}
+
+static bool runLoad(const vector<Argument> &arguments, Simulation &simulation) {
+    if (arguments.size() < 2) {
+        return false;
+    }
+    simulation.addAction(new LoadSimulation(arguments[1].str()));
+    return true;
+}
+
+struct Command {
+    const char *name;
+    bool (*run)(const vector<Argument> &arguments, Simulation &simulation);
+};
+
+static const int COMMAND_SLOTS = 16;
+
+/*
+The commands, each at the slot of commandHash(name), a perfect hash of these names: their
+first and last letters and length are enough to tell them apart. A new command goes at the
+slot its name hashes to, with a larger table or other multipliers if that slot is taken;
+the static_assert below fails the build if any entry is out of place.
+*/
+static constexpr Command COMMANDS[COMMAND_SLOTS] = {
+    {"load", runLoad},
+    {"facility", runFacility},
+    {"plan", runPlan},
+    {"settlement", runSettlement},
+    {nullptr, nullptr},
+    {nullptr, nullptr},
+    {"changePolicy", runChangePolicy},
+    {"log", runLog},
+    {"dropBackup", runDropBackup},
+    {"backups", runBackups},
+    {"save", runSave},
+    {"step", runStep},
+    {"close", runClose},
+    {"planStatus", runPlanStatus},
+    {"backup", runBackup},
+    {"restore", runRestore}
+};
+
+static constexpr int commandHash(const char *name, size_t length) {
+    return length == 0 ? 0
+        : (static_cast<unsigned char>(name[0]) + 3 * static_cast<unsigned char>(name[length - 1]) + 2 * length) % COMMAND_SLOTS;
+}
+
+static constexpr size_t nameLength(const char *name) {
+    return *name == '\0' ? 0 : 1 + nameLength(name + 1);
+}
+
+static constexpr bool commandsInPlace(int slot) {
+    return slot == COMMAND_SLOTS
+        || ((COMMANDS[slot].name == nullptr || commandHash(COMMANDS[slot].name, nameLength(COMMANDS[slot].name)) == slot)
+            && commandsInPlace(slot + 1));
+}
+
+static_assert(commandsInPlace(0), "A command is not at the slot its name hashes to");
+
+Simulation::Simulation(const string &configFilePath) : Simulation(configFilePath, 1) {}
+
+// Loads the config with numOfThreads threads, which then step the plans
+Simulation::Simulation(const string &configFilePath, const int numOfThreads) : Simulation() {
+    setNumOfThreads(numOfThreads);
+    if (ConfigImage::isImage(configFilePath)) {
+        ConfigImage::load(configFilePath, *this);
+    } else {
+        ConfigLoader::load(configFilePath, *this);
+    }
+}
+
+Simulation::Simulation() : isRunning(false), planCounter(0), currentTick(0),actionsLog(),settlements(),settlementsByName(),plans(),planIndexById(),facilitiesOptions(),readyPlans(),completionEvents(),touchedPlans(),stepChunks(),workerPool(nullptr) {}
+
+// Copy Constructor, shares the state of other until either of them changes it
+Simulation::Simulation(const Simulation& other)
+    : isRunning(other.isRunning),
+      planCounter(other.planCounter),
+      currentTick(other.currentTick),
+      actionsLog(other.actionsLog),
+      settlements(other.settlements),
+      settlementsByName(other.settlementsByName),
+      plans(other.plans),
+      planIndexById(other.planIndexById),
+      facilitiesOptions(other.facilitiesOptions),
+      readyPlans(other.readyPlans),
+      completionEvents(other.completionEvents),
+      touchedPlans(),
+      stepChunks(),
+      workerPool(nullptr) {}
+
 // Move Constructor
 Simulation::Simulation(Simulation&& other) noexcept
     : isRunning(other.isRunning),
       planCounter(other.planCounter),
-      actionsLog(),
-      plans(),
-      settlements(),
-      facilitiesOptions(other.facilitiesOptions) {
-        
-        for (size_t i = 0; i < other.actionsLog.size(); i++) {
-            actionsLog.push_back(other.actionsLog.at(i));
-            other.actionsLog.at(i) = nullptr;
-        }
-        for (size_t i = 0; i < other.settlements.size(); i++) {
-            settlements.push_back(other.settlements.at(i));
-            other.settlements.at(i) = nullptr;
-        }
-
-        for (size_t i = 0; i < other.plans.size(); i++) {
-            plans.push_back((Plan(other.plans.at(i), getSettlement(other.plans.at(i).getSettlement().getName()), facilitiesOptions)));
-        }
-        
+      currentTick(other.currentTick),
+      actionsLog(std::move(other.actionsLog)),
+      settlements(std::move(other.settlements)),
+      settlementsByName(std::move(other.settlementsByName)),
+      plans(std::move(other.plans)),
+      planIndexById(std::move(other.planIndexById)),
+      facilitiesOptions(std::move(other.facilitiesOptions)),
+      readyPlans(std::move(other.readyPlans)),
+      completionEvents(std::move(other.completionEvents)),
+      touchedPlans(),
+      stepChunks(),
+      workerPool(other.workerPool) {
+    other.workerPool = nullptr;
     other.isRunning = false;
     other.planCounter = 0;
-    other.actionsLog.clear();
-    other.plans.clear();
-    other.settlements.clear();
-    other.facilitiesOptions.clear();
+    other.currentTick = 0;
 }
 
-// Copy Assignment Operator
+// Copy Assignment Operator, keeps the worker threads of this simulation
 Simulation& Simulation::operator=(const Simulation& other) {
     if (this != &other) {
         isRunning = other.isRunning;
         planCounter = other.planCounter;
-        facilitiesOptions.clear();
+        currentTick = other.currentTick;
+        actionsLog = other.actionsLog;
+        settlements = other.settlements;
+        settlementsByName = other.settlementsByName;
+        plans = other.plans;
+        planIndexById = other.planIndexById;
         facilitiesOptions = other.facilitiesOptions;
-        plans.clear();
-        
-        for (size_t i = 0; i < actionsLog.size(); i++) {
-            delete actionsLog[i];
-        }
-        actionsLog.clear();
-
-        for (size_t i = 0; i < settlements.size(); i++) {
-            delete settlements[i];
-        }
-        settlements.clear();
-        
-        for (size_t i = 0; i < other.actionsLog.size(); i++) {
-            actionsLog.push_back(other.actionsLog[i]->clone()); //deep copy
-        }
-        
-        for (size_t i = 0; i < other.settlements.size(); i++) {
-            settlements.push_back(new Settlement(*other.settlements[i])); //deep copy
-        } 
-
-        for (Plan plan : other.plans) {
-            plans.push_back(Plan(plan, getSettlement(plan.getSettlement().getName()), facilitiesOptions));
-        }
-
+        readyPlans = other.readyPlans;
+        completionEvents = other.completionEvents;
     }
     return *this;
 }
@@ -130,204 +242,428 @@ Simulation& Simulation::operator=(const Simulation& other) {
 // Move Assignment Operator
 Simulation& Simulation::operator=(Simulation&& other) noexcept {
     if (this != &other) {
-        for (size_t i = 0; i < other.actionsLog.size(); i++) {
-            actionsLog.push_back(other.actionsLog.at(i));
-            other.actionsLog.at(i) = nullptr;
-        }
-        for (size_t i = 0; i < other.settlements.size(); i++) {
-            settlements.push_back(other.settlements.at(i));
-            other.settlements.at(i) = nullptr;
-        }
-
-        for (size_t i = 0; i < other.plans.size(); i++) {
-            plans.push_back((Plan(other.plans.at(i), getSettlement(other.plans.at(i).getSettlement().getName()), facilitiesOptions)));
-        }
-        
-    other.isRunning = false;
-    other.planCounter = 0;
-    other.actionsLog.clear();
-    other.plans.clear();
-    other.settlements.clear();
-    other.facilitiesOptions.clear();
+        isRunning = other.isRunning;
+        planCounter = other.planCounter;
+        currentTick = other.currentTick;
+        actionsLog = std::move(other.actionsLog);
+        settlements = std::move(other.settlements);
+        settlementsByName = std::move(other.settlementsByName);
+        plans = std::move(other.plans);
+        planIndexById = std::move(other.planIndexById);
+        facilitiesOptions = std::move(other.facilitiesOptions);
+        readyPlans = std::move(other.readyPlans);
+        completionEvents = std::move(other.completionEvents);
+        delete workerPool;
+        workerPool = other.workerPool;
+        other.workerPool = nullptr;
+        other.isRunning = false;
+        other.planCounter = 0;
+        other.currentTick = 0;
     }
     return *this;
 }
 
 // Destructor
 Simulation::~Simulation() {
-    for (size_t i = 0; i < actionsLog.size(); i++) {
-        delete actionsLog.at(i);
-    }
-    actionsLog.clear();
-
-    for (size_t i = 0; i < settlements.size(); i++) {
-        delete settlements.at(i);
-    }
-    settlements.clear();
+    delete workerPool;
+    workerPool = nullptr;
 }
 
 
+// Reads commands from the standard input until close, printing the output of each right away
 void Simulation::start() {
     open();
-    while (isRunning){
-        string Input;
-        std::getline(std::cin, Input);
-        std::vector<std::string> cur_line = Auxiliary::parseArguments(Input);
-        string command = cur_line[0];
-        if (command == "step"){
-            int steps = std::stoi(cur_line[1]);
-            addAction(new SimulateStep(steps));
-        }
-        else if (command=="plan"){
-            string settlementName = cur_line[1];
-            string selectionPolicy = cur_line[2];
-            addAction(new AddPlan(settlementName, selectionPolicy));
-        }
-        else if (command=="settlement"){
-            string settlementName = cur_line[1];
-            SettlementType settlementType = static_cast<SettlementType>(std::stoi(cur_line[2]));
-            addAction(new AddSettlement(settlementName, settlementType));
-        }
-        else if (command=="facility"){
-            addAction(new AddFacility(cur_line[1], static_cast<FacilityCategory>(std::stoi(cur_line[2])), std::stoi(cur_line[3]), std::stoi(cur_line[4]), std::stoi(cur_line[5]), std::stoi(cur_line[6])));
-        }
-        else if (command=="planStatus"){
-            int planID = std::stoi(cur_line[1]);
-            addAction(new PrintPlanStatus(planID));
-        }
-        else if (command=="changePolicy"){
-            int planID = std::stoi(cur_line[1]);
-            string selectionPolicy = cur_line[2];
-            addAction(new ChangePlanPolicy(planID, selectionPolicy));
-        }
-        else if (command=="log"){
-            addAction(new PrintActionsLog());
-        }
-        else if (command=="close"){
-            addAction(new Close());
-        }
-        else if (command=="backup"){
-            addAction(new BackupSimulation());
-        }
-        else if (command=="restore"){
-            addAction(new RestoreSimulation());
-        }
-        else{
-            std::cout << "Invalid command" << std::endl;
+    string input;
+    vector<Argument> arguments;
+    while (isRunning && std::getline(std::cin, input)){
+        runCommand(input.data(), input.data() + input.size(), arguments);
+        output.flush();
+    }
+}
+
+// Runs the commands of a script file until close or its end, with no flush in between.
+// Returns the number of commands, non-empty lines, run.
+size_t Simulation::runScript(const string &scriptPath) {
+    MappedFile script(scriptPath, "script");
+    open();
+    vector<Argument> arguments;
+    size_t numOfCommands = 0;
+    const char *position = script.getData();
+    const char *end = position + script.getSize();
+    while (isRunning && position != end) {
+        const char *lineEnd = static_cast<const char*>(std::memchr(position, '\n', end - position));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
         }
-       }
+        runCommand(position, lineEnd, arguments);
+        numOfCommands += lineEnd != position;
+        position = lineEnd == end ? end : lineEnd + 1;
+    }
+    output.flush();
+    return numOfCommands;
+}
+
+/*
+Runs the command on the line [begin, end). The line is split in place, into arguments that
+are reused from line to line, the command is found in COMMANDS with one hash and one compare,
+and its numbers are parsed without exceptions; a line with missing or malformed arguments is
+reported and skipped.
+*/
+void Simulation::runCommand(const char *begin, const char *end, vector<Argument> &arguments) {
+    Auxiliary::splitArguments(begin, end, arguments);
+    if (arguments.empty()) {
+        return;
+    }
+    const Argument &name = arguments[0];
+    const Command &command = COMMANDS[commandHash(name.data, name.length)];
+    if (command.name == nullptr || name != command.name) {
+        output << "Invalid command" << '\n';
+        return;
+    }
+    if (!command.run(arguments, *this)) {
+        output << "Invalid arguments: ";
+        output.write(begin, end - begin);
+        output << '\n';
+    }
 }
 
 void Simulation::addPlan(const Settlement &settlement, SelectionPolicy *selectionPolicy) {
     if (selectionPolicy == nullptr) {
         throw std::runtime_error("Selection policy is null");
     }
-    plans.push_back(Plan(planCounter++, settlement, selectionPolicy, facilitiesOptions));
-    
+    const int planIndex = static_cast<int>(plans.size());
+    readyPlans.edit().push_back(planIndex);
+    while (planIndexById.size() < static_cast<size_t>(planCounter)) {
+        planIndexById.push_back(-1);
+    }
+    planIndexById.push_back(planIndex);
+    plans.push_back(CopyOnWrite<Plan>(new Plan(planCounter++, settlement, selectionPolicy)));
 }
 
 void Simulation::addAction(BaseAction *action) {
     if (action == nullptr) {
         throw std::runtime_error("Action is null");
     }
+    std::unique_ptr<BaseAction> owned(action);
+    if (journal.isOpen()) {
+        ActionLog &log = actionsLog.edit();
+        journal.beforeAction(action->toRecord(log), log);
+    }
     action->act(*this);
-    actionsLog.push_back(action);
+    ActionLog &log = actionsLog.edit();  // The action may have replaced the simulation, and its log
+    const ActionLog::Record record = action->toRecord(log);
+    log.append(record);
+    if (journal.isOpen()) {
+        journal.afterAction(record, *this);
+    }
 }
 
 bool Simulation::addSettlement(Settlement *settlement) {
     if (settlement == nullptr) {
         throw std::runtime_error("Selection policy is null");
     }
-    if (isSettlementExists(settlement->getName())) {
+    if (settlementsByName->count(settlement->getName()) != 0) {
         return false;
     }
-    settlements.push_back(settlement);
+    settlementsByName.edit()[settlement->getName()] = settlement;
+    settlements.edit().push_back(std::shared_ptr<Settlement>(settlement));
     return true;
 }
 
 bool Simulation::addFacility(FacilityType facility) {
-    if (isFacilityExists(facility.getName())) {
-        throw std::runtime_error("Facility already exists");
+    if (facilitiesOptions->contains(facility.getName())) {
         return false;
     }
-    facilitiesOptions.push_back(facility);
+    facilitiesOptions.edit().add(facility);
     return true;
 }
 
 bool Simulation::isSettlementExists(const string &settlementName) {
-    for (Settlement *settlement : settlements) {
-        if (settlement->getName() == settlementName) {
-            return true;
-        }
-    }
-    return false;
+    return settlementsByName->count(settlementName) != 0;
 }
 
 bool Simulation::isFacilityExists(const string &facilityName) {
-    for (FacilityType facility : facilitiesOptions) {
-        if (facility.getName() == facilityName) {
-            return true;
-        }
-    }
-    return false;
+    return facilitiesOptions->contains(facilityName);
 }
 
 Settlement &Simulation::getSettlement(const string &settlementName) {
-    for (Settlement *settlement : settlements) {
-        if (settlement->getName() == settlementName) {
-            return *settlement;
-        }
+    std::unordered_map<string, Settlement*>::const_iterator found = settlementsByName->find(settlementName);
+    if (found != settlementsByName->end()) {
+        return *found->second;
     }
     throw std::runtime_error("Cannot create this plan");
 }
 
 const vector<Settlement*> Simulation::getSettlements() {
-    return settlements;
+    vector<Settlement*> result;
+    for (const std::shared_ptr<Settlement> &settlement : settlements.get()) {
+        result.push_back(settlement.get());
+    }
+    return result;
 }
 
-vector<BaseAction*> Simulation::getActionsLog() {
-    return actionsLog;
+const ActionLog &Simulation::getActionsLog() const {
+    return actionsLog.get();
 }
 
-bool Simulation::planExists(const int planID) {
-    for (auto& plan : plans) {
-        if (plan.getId() == planID) {
-            return true;
-        }
+bool Simulation::planExists(const int planID) const {
+    return planID >= 0 && static_cast<size_t>(planID) < planIndexById.size() && planIndexById[planID] != -1;
+}
+
+// Reads the plan where it is, shared or not
+const Plan &Simulation::getPlan(const int planID) const {
+    if (!planExists(planID)) {
+        throw std::runtime_error("Plan doesn't exist");
     }
-    return false;
+    return plans[planIndexById[planID]].get();
 }
 
+// The plan, and its chunk of the plan table, are copied first if a backup still shares them
 Plan &Simulation::getPlan(const int planID) {
-    for (auto& plan : plans) {
-        if (plan.getId() == planID) {
-            return plan;
-        }
+    if (!planExists(planID)) {
+        throw std::runtime_error("Plan doesn't exist");
     }
-    throw std::runtime_error("Plan doesn't exist");
+    return plans.edit(planIndexById[planID]).edit();
 }
 
+/*
+Event driven step: only plans that are available or have a facility finishing in this
+tick are visited, so a tick in which nothing finishes costs O(1).
+The visited plans are stepped in chunks, on the worker threads when there are enough of
+them. Chunks are merged back in order, so the result does not depend on the threads.
+After a backup, only the chunks of the tables that hold visited plans are copied.
+*/
 void Simulation::step() {
     if (!isRunning) {
         throw std::runtime_error("Simulation is not running");
     }
-    for (Plan &plan : plans) {
-        plan.step();
+    const int tick = ++currentTick;
+    touchedPlans.assign(readyPlans->begin(), readyPlans->end());
+    if (readyPlans.isShared()) {
+        readyPlans = CopyOnWrite<vector<int>>();  // Emptied anyway, so not copied from a backup
+    }
+    vector<int> &ready = readyPlans.edit();
+    ready.clear();
+    CompletionEvents &events = completionEvents.edit();
+    CompletionEvents::iterator finishing = events.find(tick);
+    if (finishing != events.end()) {
+        for (size_t i = 0; i < finishing->second.size(); i++) {
+            touchedPlans.push_back(finishing->second[i]);
+        }
+        events.erase(finishing);
+    }
+    std::sort(touchedPlans.begin(), touchedPlans.end());
+    touchedPlans.erase(std::unique(touchedPlans.begin(), touchedPlans.end()), touchedPlans.end());
+
+    editTouchedPlans();
+    const int numOfChunks = partitionTouchedPlans();
+    runChunks(numOfChunks, [this, tick](int chunk, int worker) {
+        stepPlans(stepChunks[chunk], tick);
+    });
+    for (int chunk = 0; chunk < numOfChunks; chunk++) {
+        for (const CompletionEvent &event : stepChunks[chunk].events) {
+            events[event.first].push_back(event.second);
+        }
+        ready.insert(ready.end(), stepChunks[chunk].readyPlans.begin(), stepChunks[chunk].readyPlans.end());
+    }
+}
+
+/*
+Runs numOfSteps steps. Plans never affect each other, so long runs let every plan fast
+forward on its own (see Plan::fastForward) and rebuild the step events afterwards.
+*/
+void Simulation::step(const int numOfSteps) {
+    if (numOfSteps < FAST_FORWARD_MIN_STEPS) {
+        for (int i = 0; i < numOfSteps; i++) {
+            step();
+        }
+        return;
+    }
+    if (!isRunning) {
+        throw std::runtime_error("Simulation is not running");
+    }
+    touchedPlans.clear();
+    for (size_t planIndex = 0; planIndex < plans.size(); planIndex++) {
+        touchedPlans.push_back(static_cast<int>(planIndex));
+    }
+    const int tick = currentTick;
+    const FacilityCatalog &catalog = facilitiesOptions.get();
+    editTouchedPlans();
+    const int numOfChunks = partitionTouchedPlans();
+    runChunks(numOfChunks, [this, tick, numOfSteps, &catalog](int chunk, int worker) {
+        for (size_t i = stepChunks[chunk].begin; i < stepChunks[chunk].end; i++) {
+            plans.edit(touchedPlans[i]).edit().fastForward(tick, numOfSteps, catalog);
+        }
+    });
+    currentTick += numOfSteps;
+    rebuildEvents();
+}
+
+void Simulation::setNumOfThreads(const int numOfThreads) {
+    delete workerPool;
+    workerPool = nullptr;
+    if (numOfThreads > 1) {
+        workerPool = new WorkerPool(numOfThreads);
+    }
+}
+
+void Simulation::rebuildEvents() {
+    readyPlans = CopyOnWrite<vector<int>>();
+    vector<int> &ready = readyPlans.edit();
+    CompletionEvents &events = completionEvents.edit();
+    events.clear();
+    for (size_t planIndex = 0; planIndex < plans.size(); planIndex++) {
+        const Plan &plan = plans[planIndex].get();
+        if (plan.isAvailable()) {
+            ready.push_back(static_cast<int>(planIndex));
+        }
+        const ConstructionQueue &underConstruction = plan.getUnderConstruction();
+        for (int slot = 0; slot < underConstruction.size(); slot++) {
+            if (underConstruction.getFinishTick(slot) > currentTick) {
+                events[underConstruction.getFinishTick(slot)].push_back(static_cast<int>(planIndex));
+            }
+        }
+    }
+}
+
+// Makes the chunks of the plan table that hold the visited plans private, before the
+// workers step them: a worker then only copies the plans it steps, if a backup shares them
+void Simulation::editTouchedPlans() {
+    for (int planIndex : touchedPlans) {
+        plans.edit(planIndex);
+    }
+}
+
+/*
+Splits touchedPlans into chunks of about the same construction load: a plan in a
+metropolis builds three facilities where a plan in a village builds one.
+Returns the number of chunks, a single one when stepping on one thread.
+*/
+int Simulation::partitionTouchedPlans() {
+    int numOfChunks = 1;
+    if (workerPool != nullptr && touchedPlans.size() >= PARALLEL_MIN_PLANS) {
+        numOfChunks = workerPool->size() * CHUNKS_PER_WORKER;
+    }
+    if (stepChunks.size() < static_cast<size_t>(numOfChunks)) {
+        stepChunks.resize(numOfChunks);
+    }
+    long long totalLoad = 0;
+    for (int planIndex : touchedPlans) {
+        totalLoad += plans[planIndex]->getSettlement().constructionLimit();
+    }
+    size_t end = 0;
+    long long load = 0;
+    for (int chunk = 0; chunk < numOfChunks; chunk++) {
+        const long long chunkEndLoad = totalLoad * (chunk + 1) / numOfChunks;
+        stepChunks[chunk].begin = end;
+        while (end < touchedPlans.size() && (load < chunkEndLoad || chunk == numOfChunks - 1)) {
+            load += plans[touchedPlans[end]]->getSettlement().constructionLimit();
+            end++;
+        }
+        stepChunks[chunk].end = end;
+    }
+    return numOfChunks;
+}
+
+void Simulation::runChunks(const int numOfChunks, const WorkerPool::Task &task) {
+    if (workerPool == nullptr || numOfChunks == 1) {
+        for (int chunk = 0; chunk < numOfChunks; chunk++) {
+            task(chunk, 0);
+        }
+        return;
+    }
+    workerPool->run(numOfChunks, task);
+}
+
+/*
+Makes the picks of the chunk's balanced plans together through a BalancedBatch, so the
+catalog is read once per tile and round instead of once per plan.
+Plans that were not batched are left with -1 as their first pick.
+*/
+void Simulation::selectBalanced(StepChunk &chunk) {
+    chunk.selected.assign((chunk.end - chunk.begin) * Settlement::MAX_CONSTRUCTION_LIMIT, -1);
+    chunk.balancedBatch.clear();
+    if (facilitiesOptions->empty()) {
+        return;  // every plan throws on its own, in order
+    }
+    for (size_t i = chunk.begin; i < chunk.end; i++) {
+        Plan &plan = plans.edit(touchedPlans[i]).edit();
+        const int freeSlots = plan.getFreeSlots();
+        BalancedSelection *policy = dynamic_cast<BalancedSelection*>(plan.getSelectionPolicy());
+        if (freeSlots > 0 && policy != nullptr) {
+            chunk.balancedBatch.add(*policy, &chunk.selected[(i - chunk.begin) * Settlement::MAX_CONSTRUCTION_LIMIT], freeSlots);
+        }
+    }
+    chunk.balancedBatch.select(facilitiesOptions.get());
+}
+
+// Steps the plans of a chunk. A plan still shared with a backup is copied first.
+void Simulation::stepPlans(StepChunk &chunk, const int tick) {
+    chunk.events.clear();
+    chunk.readyPlans.clear();
+    selectBalanced(chunk);
+    const FacilityCatalog &catalog = facilitiesOptions.get();
+    for (size_t i = chunk.begin; i < chunk.end; i++) {
+        const int planIndex = touchedPlans[i];
+        Plan &plan = plans.edit(planIndex).edit();
+        const int *selected = &chunk.selected[(i - chunk.begin) * Settlement::MAX_CONSTRUCTION_LIMIT];
+        const int started = selected[0] >= 0 ? plan.startConstruction(tick, catalog, selected) : plan.startConstruction(tick, catalog);
+        const ConstructionQueue &underConstruction = plan.getUnderConstruction();
+        for (int slot = underConstruction.size() - started; slot < underConstruction.size(); slot++) {
+            if (underConstruction.getFinishTick(slot) > tick) {
+                chunk.events.push_back(CompletionEvent(underConstruction.getFinishTick(slot), planIndex));
+            }
+        }
+        if (plan.completeConstruction(tick)) {
+            chunk.readyPlans.push_back(planIndex);
+        }
     }
 }
 
 void Simulation::close() {
     isRunning = false;
-    for (Plan &plan : plans) {
-        std::cout << "PlanID: " + std::to_string(plan.getId()) << std::endl;
-        std::cout << "SettlementName: " + plan.getSettlement().getName() << std::endl;
-        std::cout << "LifeQualityScore: " + std::to_string(plan.getlifeQualityScore()) << std::endl;
-        std::cout << "EconomyScore: " + std::to_string(plan.getEconomyScore()) << std::endl;
-        std::cout << "EnvironmentScore: " + std::to_string(plan.getEnvironmentScore()) << std::endl;
+    for (size_t planIndex = 0; planIndex < plans.size(); planIndex++) {
+        const Plan &plan = plans[planIndex].get();
+        report.beginRecord();
+        report.field("PlanID", plan.getId());
+        report.field("SettlementName", plan.getSettlement().getName());
+        report.field("LifeQualityScore", plan.getlifeQualityScore());
+        report.field("EconomyScore", plan.getEconomyScore());
+        report.field("EnvironmentScore", plan.getEnvironmentScore());
+        report.endRecord();
+    }
+}
+
+const FacilityCatalog &Simulation::getFacilityOptions() const {
+    return facilitiesOptions.get();
+}
+
+int Simulation::getCurrentTick() const {
+    return currentTick;
+}
+
+// Compares by sharing, so a plan that changed and changed back still counts. parent may be nullptr.
+SimulationDelta Simulation::diff(const Simulation *parent) const {
+    SimulationDelta delta;
+    for (size_t planIndex = 0; planIndex < plans.size(); planIndex++) {
+        size_t parentFacilities = 0;
+        if (parent != nullptr && planIndex < parent->plans.size()) {
+            const CopyOnWrite<Plan> &parentPlan = parent->plans[planIndex];
+            if (plans[planIndex].sharesWith(parentPlan)) {
+                continue;
+            }
+            parentFacilities = parentPlan->getFacilities().size();
+        }
+        delta.changedPlans++;
+        const size_t facilities = plans[planIndex]->getFacilities().size();
+        delta.newFacilities += (facilities > parentFacilities ? facilities - parentFacilities : 0);
     }
+    const size_t parentActions = (parent == nullptr ? 0 : parent->actionsLog->size());
+    delta.newActions = (actionsLog->size() > parentActions ? actionsLog->size() - parentActions : 0);
+    return delta;
 }
 
 void Simulation::open() {
     isRunning = true;
-    std::cout << "The simulation has started" << std::endl;
+    output << "The simulation has started" << '\n';
 }
@@ -0,0 +1,270 @@
+#include "Snapshot.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+const char Snapshot::MAGIC[8] = {'S', 'I', 'M', 'S', 'N', 'A', 'P', '\x01'};
+
+static uint64_t alignTo8(uint64_t offset) {
+    return (offset + 7) / 8 * 8;
+}
+
+template <typename T>
+static void writeRecords(std::ofstream &file, const vector<T> &records, uint64_t offset) {
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(T)));
+}
+
+// Methods
+Snapshot::StringRef Snapshot::addString(string &strings, const string &value) {
+    StringRef ref;
+    std::memset(&ref, 0, sizeof(ref));
+    ref.offset = strings.size();
+    ref.length = static_cast<uint32_t>(value.size());
+    strings += value;
+    return ref;
+}
+
+string Snapshot::readString(const char *strings, uint64_t stringsSize, const StringRef &ref) {
+    if (ref.offset > stringsSize || ref.length > stringsSize - ref.offset) {
+        throw std::runtime_error("Invalid snapshot");
+    }
+    return ref.length == 0 ? string() : string(strings + ref.offset, ref.length);
+}
+
+void Snapshot::save(const Simulation &simulation, const string &path) {
+    string strings;
+    const vector<std::shared_ptr<Settlement>> &settlements = simulation.settlements.get();
+    vector<SettlementRecord> settlementRecords(settlements.size());
+    std::unordered_map<const Settlement*, int32_t> settlementIndex;
+    for (size_t i = 0; i < settlements.size(); i++) {
+        std::memset(&settlementRecords[i], 0, sizeof(SettlementRecord));
+        settlementRecords[i].name = addString(strings, settlements[i]->getName());
+        settlementRecords[i].type = static_cast<int32_t>(settlements[i]->getType());
+        settlementIndex[settlements[i].get()] = static_cast<int32_t>(i);
+    }
+
+    const FacilityCatalog &catalog = simulation.facilitiesOptions.get();
+    vector<FacilityTypeRecord> facilityTypeRecords(catalog.size());
+    for (size_t i = 0; i < catalog.size(); i++) {
+        FacilityTypeRecord &record = facilityTypeRecords[i];
+        std::memset(&record, 0, sizeof(FacilityTypeRecord));
+        record.name = addString(strings, catalog[i].getName());
+        record.category = static_cast<int32_t>(catalog[i].getCategory());
+        record.price = catalog[i].getCost();
+        record.lifeQualityScore = catalog[i].getLifeQualityScore();
+        record.economyScore = catalog[i].getEconomyScore();
+        record.environmentScore = catalog[i].getEnvironmentScore();
+    }
+
+    const SharedChunkList<CopyOnWrite<Plan>> &plans = simulation.plans;
+    vector<PlanRecord> planRecords(plans.size());
+    vector<int32_t> facilities;
+    for (size_t i = 0; i < plans.size(); i++) {
+        const Plan &plan = plans[i].get();
+        PlanRecord &record = planRecords[i];
+        std::memset(&record, 0, sizeof(PlanRecord));
+        record.id = plan.getId();
+        record.settlement = settlementIndex.at(&plan.getSettlement());
+        record.available = plan.isAvailable() ? 1 : 0;
+        record.policy = SelectionPolicy::findPolicy(plan.getSelectionPolicy()->toString());
+        plan.getSelectionPolicy()->getState(record.policyState);
+        record.lifeQualityScore = plan.getlifeQualityScore();
+        record.economyScore = plan.getEconomyScore();
+        record.environmentScore = plan.getEnvironmentScore();
+        const ConstructionQueue &underConstruction = plan.getUnderConstruction();
+        record.numOfUnderConstruction = underConstruction.size();
+        for (int slot = 0; slot < underConstruction.size(); slot++) {
+            record.finishTicks[slot] = underConstruction.getFinishTick(slot);
+            record.typeIds[slot] = underConstruction.getTypeId(slot);
+        }
+        const RunList<Facility> &planFacilities = plan.getFacilities();
+        record.firstFacility = facilities.size();
+        record.numOfFacilities = planFacilities.size();
+        for (size_t j = 0; j < planFacilities.size(); j++) {
+            facilities.push_back(planFacilities[j].getTypeId());
+        }
+    }
+
+    const ActionLog &actionsLog = simulation.actionsLog.get();
+    vector<ActionRecord> actionRecords(actionsLog.size());
+    for (size_t i = 0; i < actionsLog.size(); i++) {
+        const ActionLog::Record &action = actionsLog[i];
+        actionRecords[i].kind = static_cast<int32_t>(action.kind);
+        actionRecords[i].completed = action.completed ? 1 : 0;
+        std::memcpy(actionRecords[i].args, action.args, sizeof(action.args));
+    }
+    vector<StringRef> logStringRecords(actionsLog.getNumOfStrings());
+    for (size_t i = 0; i < logStringRecords.size(); i++) {
+        logStringRecords[i] = addString(strings, actionsLog.getString(static_cast<int32_t>(i)));
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.isRunning = simulation.isRunning ? 1 : 0;
+    header.currentTick = simulation.currentTick;
+    header.planCounter = simulation.planCounter;
+    header.numOfSettlements = settlementRecords.size();
+    header.settlementsOffset = alignTo8(sizeof(Header));
+    header.numOfFacilityTypes = facilityTypeRecords.size();
+    header.facilityTypesOffset = alignTo8(header.settlementsOffset + settlementRecords.size() * sizeof(SettlementRecord));
+    header.numOfPlans = planRecords.size();
+    header.plansOffset = alignTo8(header.facilityTypesOffset + facilityTypeRecords.size() * sizeof(FacilityTypeRecord));
+    header.numOfFacilities = facilities.size();
+    header.facilitiesOffset = alignTo8(header.plansOffset + planRecords.size() * sizeof(PlanRecord));
+    header.numOfActions = actionRecords.size();
+    header.actionsOffset = alignTo8(header.facilitiesOffset + facilities.size() * sizeof(int32_t));
+    header.numOfLogStrings = logStringRecords.size();
+    header.logStringsOffset = alignTo8(header.actionsOffset + actionRecords.size() * sizeof(ActionRecord));
+    header.stringsSize = strings.size();
+    header.stringsOffset = alignTo8(header.logStringsOffset + logStringRecords.size() * sizeof(StringRef));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to write snapshot");
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    writeRecords(file, settlementRecords, header.settlementsOffset);
+    writeRecords(file, facilityTypeRecords, header.facilityTypesOffset);
+    writeRecords(file, planRecords, header.plansOffset);
+    writeRecords(file, facilities, header.facilitiesOffset);
+    writeRecords(file, actionRecords, header.actionsOffset);
+    writeRecords(file, logStringRecords, header.logStringsOffset);
+    file.seekp(static_cast<std::streamoff>(header.stringsOffset));
+    file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+    if (!file) {
+        throw std::runtime_error("Unable to write snapshot");
+    }
+}
+
+/*
+Builds the simulation straight from the mapped records. Everything that refers to another
+record (settlement and facility type indices, facility ranges, strings) is checked first,
+so a damaged file throws instead of building a broken simulation.
+*/
+Simulation Snapshot::load(const string &path) {
+    std::unordered_map<string, std::shared_ptr<Settlement>> settlementPool;
+    return load(path, settlementPool);
+}
+
+/*
+Same, taking the settlements from settlementPool when it has one of the same name and type
+(settlements never change) and adding the others: simulations loaded with one pool can then
+share plans, as copies of one another do, since the settlements they refer to are the same.
+*/
+Simulation Snapshot::load(const string &path, std::unordered_map<string, std::shared_ptr<Settlement>> &settlementPool) {
+    MappedFile file(path, "snapshot");
+    const Header *header = file.records<Header>(0, 1);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION) {
+        throw std::runtime_error("Invalid snapshot");
+    }
+    const SettlementRecord *settlementRecords = file.records<SettlementRecord>(header->settlementsOffset, header->numOfSettlements);
+    const FacilityTypeRecord *facilityTypeRecords = file.records<FacilityTypeRecord>(header->facilityTypesOffset, header->numOfFacilityTypes);
+    const PlanRecord *planRecords = file.records<PlanRecord>(header->plansOffset, header->numOfPlans);
+    const int32_t *facilities = file.records<int32_t>(header->facilitiesOffset, header->numOfFacilities);
+    const ActionRecord *actionRecords = file.records<ActionRecord>(header->actionsOffset, header->numOfActions);
+    const StringRef *logStringRecords = file.records<StringRef>(header->logStringsOffset, header->numOfLogStrings);
+    const char *strings = file.records<char>(header->stringsOffset, header->stringsSize);
+
+    Simulation simulation;
+    simulation.isRunning = header->isRunning != 0;
+    simulation.currentTick = header->currentTick;
+    simulation.planCounter = header->planCounter;
+
+    vector<std::shared_ptr<Settlement>> &settlements = simulation.settlements.edit();
+    std::unordered_map<string, Settlement*> &settlementsByName = simulation.settlementsByName.edit();
+    settlements.reserve(header->numOfSettlements);
+    for (uint64_t i = 0; i < header->numOfSettlements; i++) {
+        const SettlementRecord &record = settlementRecords[i];
+        if (record.type < 0 || record.type > static_cast<int32_t>(SettlementType::METROPOLIS)) {
+            throw std::runtime_error("Invalid snapshot");
+        }
+        const string name = readString(strings, header->stringsSize, record.name);
+        const SettlementType type = static_cast<SettlementType>(record.type);
+        std::shared_ptr<Settlement> &pooled = settlementPool[name];
+        if (pooled == nullptr) {
+            pooled = std::make_shared<Settlement>(name, type);
+        }
+        settlements.push_back(pooled->getType() == type ? pooled : std::make_shared<Settlement>(name, type));
+        if (!settlementsByName.emplace(name, settlements.back().get()).second) {
+            throw std::runtime_error("Invalid snapshot");
+        }
+    }
+
+    FacilityCatalog &catalog = simulation.facilitiesOptions.edit();
+    for (uint64_t i = 0; i < header->numOfFacilityTypes; i++) {
+        const FacilityTypeRecord &record = facilityTypeRecords[i];
+        // A duplicate name would not be added, and shift the type ids of the ones after it
+        if (record.category < 0 || record.category > static_cast<int32_t>(FacilityCategory::ENVIRONMENT)
+            || !catalog.add(FacilityType(readString(strings, header->stringsSize, record.name), static_cast<FacilityCategory>(record.category), record.price, record.lifeQualityScore, record.economyScore, record.environmentScore))) {
+            throw std::runtime_error("Invalid snapshot");
+        }
+    }
+
+    SharedChunkList<CopyOnWrite<Plan>> &plans = simulation.plans;
+    SharedChunkList<int> &planIndexById = simulation.planIndexById;
+    for (int id = 0; id < header->planCounter; id++) {
+        planIndexById.push_back(-1);
+    }
+    for (uint64_t i = 0; i < header->numOfPlans; i++) {
+        const PlanRecord &record = planRecords[i];
+        if (record.settlement < 0 || static_cast<uint64_t>(record.settlement) >= header->numOfSettlements
+            || record.id < 0 || static_cast<size_t>(record.id) >= planIndexById.size() || planIndexById[record.id] != -1
+            || record.policy < 0 || record.policy >= SelectionPolicy::NUM_OF_POLICIES
+            || record.firstFacility > header->numOfFacilities || record.numOfFacilities > header->numOfFacilities - record.firstFacility) {
+            throw std::runtime_error("Invalid snapshot");
+        }
+        const Settlement &settlement = *settlements[record.settlement];
+        if (record.numOfUnderConstruction < 0 || record.numOfUnderConstruction > settlement.constructionLimit()) {
+            throw std::runtime_error("Invalid snapshot");
+        }
+        SelectionPolicy *policy = SelectionPolicy::create(record.policy);
+        policy->setState(record.policyState);
+        Plan *plan = new Plan(record.id, settlement, policy);
+        plans.push_back(CopyOnWrite<Plan>(plan));
+        planIndexById.edit(record.id) = static_cast<int>(i);
+        plan->restore(record.available != 0, record.lifeQualityScore, record.economyScore, record.environmentScore);
+        for (int slot = 0; slot < record.numOfUnderConstruction; slot++) {
+            if (record.typeIds[slot] < 0 || static_cast<size_t>(record.typeIds[slot]) >= catalog.size()) {
+                throw std::runtime_error("Invalid snapshot");
+            }
+            plan->resumeConstruction(catalog[record.typeIds[slot]], record.typeIds[slot], record.finishTicks[slot]);
+        }
+        const int32_t *typeIds = facilities + record.firstFacility;
+        for (uint64_t j = 0; j < record.numOfFacilities; j++) {
+            if (typeIds[j] < 0 || static_cast<size_t>(typeIds[j]) >= catalog.size()) {
+                throw std::runtime_error("Invalid snapshot");
+            }
+            plan->addFacility(Facility(typeIds[j], settlement));
+        }
+    }
+
+    // The log interns its strings, so they are unique and get back the ids they were saved with
+    ActionLog &actionsLog = simulation.actionsLog.edit();
+    for (uint64_t i = 0; i < header->numOfLogStrings; i++) {
+        if (actionsLog.intern(readString(strings, header->stringsSize, logStringRecords[i])) != static_cast<int32_t>(i)) {
+            throw std::runtime_error("Invalid snapshot");
+        }
+    }
+    for (uint64_t i = 0; i < header->numOfActions; i++) {
+        const ActionRecord &record = actionRecords[i];
+        if (record.kind < 0 || record.kind >= ActionLog::NUM_OF_KINDS) {
+            throw std::runtime_error("Invalid snapshot");
+        }
+        ActionLog::Record action;
+        action.kind = static_cast<ActionLog::Kind>(record.kind);
+        action.completed = record.completed != 0;
+        for (int arg = 0; arg < ActionLog::MAX_ARGS; arg++) {
+            action.args[arg] = record.args[arg];
+            if (ActionLog::isStringArg(action.kind, arg) && (record.args[arg] < -1 || static_cast<uint64_t>(record.args[arg] + 1) > header->numOfLogStrings)) {
+                throw std::runtime_error("Invalid snapshot");
+            }
+        }
+        actionsLog.append(action);
+    }
+    simulation.rebuildEvents();
+    return simulation;
+}
@@ -0,0 +1,85 @@
+#include "WorkerPool.h"
+
+// Constructor
+WorkerPool::WorkerPool(int numOfWorkers)
+    : threads(), mutex(), wakeUp(), finished(), task(nullptr), numOfTasks(0), nextTask(0), busyWorkers(0), generation(0), stopping(false), failure() {
+    for (int worker = 1; worker < numOfWorkers; worker++) {
+        threads.push_back(std::thread(&WorkerPool::work, this, worker));
+    }
+}
+
+// Destructor
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads.at(i).join();
+    }
+}
+
+// Methods
+int WorkerPool::size() const {
+    return static_cast<int>(threads.size()) + 1;
+}
+
+/*
+Runs task(i, worker) for every i in [0, numOfTasks) and returns once all of them are done.
+Tasks are handed out in order to whichever worker is free. If a task throws, the first
+exception is rethrown here after the batch has finished.
+*/
+void WorkerPool::run(int numOfTasks, const Task &task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->numOfTasks = numOfTasks;
+        nextTask = 0;
+        busyWorkers = static_cast<int>(threads.size());
+        failure = nullptr;
+        generation++;
+    }
+    wakeUp.notify_all();
+    runTasks(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return busyWorkers == 0; });
+    this->task = nullptr;
+    if (failure) {
+        std::exception_ptr error = failure;
+        failure = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkerPool::work(int worker) {
+    unsigned long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        runTasks(worker);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            finished.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runTasks(int worker) {
+    for (int i = nextTask++; i < numOfTasks; i = nextTask++) {
+        try {
+            (*task)(i, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+}
@@ -1,4 +1,10 @@
+#include "Auxiliary.h"
+#include "Journal.h"
+#include "OutputWriter.h"
+#include "ReportFormatter.h"
 #include "Simulation.h"
+#include "Snapshot.h"
+#include <cstring>
 #include <iostream>
 
 using namespace std;
@@ -6,18 +12,77 @@ using namespace std;
 Simulation* backup = nullptr;
 
 int main(int argc, char** argv){
-    if(argc!=2){
-        cout << "usage: simulation <config_path>" << endl;
+    string configurationFile;
+    string snapshotFile;
+    string scriptFile;
+    string journalFile;
+    string recoverFile;
+    int numOfThreads = 0;
+    bool validArguments = argc>=2;
+    for(int i=1; i<argc && validArguments; i++){
+        string argument = argv[i];
+        if(argument=="--threads" && i+1<argc){
+            i++;
+            Argument count = {argv[i], strlen(argv[i])};
+            validArguments = Auxiliary::parseInt(count, numOfThreads);
+        }
+        else if(argument=="--resume" && i+1<argc){
+            snapshotFile = argv[++i];
+        }
+        else if(argument=="--journal" && i+1<argc){
+            journalFile = argv[++i];
+        }
+        else if(argument=="--recover" && i+1<argc){
+            recoverFile = argv[++i];
+        }
+        else if(argument=="--script" && i+1<argc){
+            scriptFile = argv[++i];
+        }
+        else if(argument=="--report" && i+1<argc){
+            ReportFormat format = ReportFormat::TEXT;
+            validArguments = ReportFormatter::parseFormat(argv[++i], format);
+            report.setFormat(format);
+        }
+        else if(argument.compare(0, 2, "--")!=0 && configurationFile.empty()){
+            configurationFile = argument;
+        }
+        else{
+            validArguments = false;
+        }
+    }
+    const int numOfSources = !configurationFile.empty() + !snapshotFile.empty() + !recoverFile.empty();
+    if(!validArguments || numOfSources!=1 || (!recoverFile.empty() && !journalFile.empty())){
+        cout << "usage: simulation (<config_path> | --resume <snapshot> | --recover <journal>) [--journal <path>] [--threads <count>] [--script <commands_path>] [--report text|csv|json]" << endl;
         return 0;
     }
-    string configurationFile = argv[1];
-    Simulation simulation(configurationFile);
-    simulation.start();
+    // Output is buffered until a line or script ends: what was printed before an error must not be lost
+    try{
+        Simulation simulation = !recoverFile.empty() ? journal.recover(recoverFile, numOfThreads)
+            : snapshotFile.empty() ? Simulation(configurationFile, numOfThreads) : Snapshot::load(snapshotFile);
+        if(!snapshotFile.empty()){
+            simulation.setNumOfThreads(numOfThreads);
+        }
+        if(!journalFile.empty()){
+            journal.create(journalFile, simulation);
+        }
+        if(scriptFile.empty()){
+            simulation.start();
+        }
+        else{
+            simulation.runScript(scriptFile);
+        }
+    }catch(const std::exception &e){
+        output.flush();
+        journal.close();
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    journal.close();
     if(backup!=nullptr){
     	delete backup;
     	backup = nullptr;
     }
 
-    
+
     return 0;
-}
\ No newline at end of file
+}
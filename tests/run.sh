@@ -0,0 +1,91 @@
+#!/bin/bash
+# Regression tests for the command line tools, run by make test after a build.
+# Each test is a function run in a fresh temporary directory; it fails by returning non-zero.
+cd "$(dirname "$0")/.." || exit 1
+BIN=$PWD/bin
+failures=0
+
+run() {
+    local dir
+    dir=$(mktemp -d)
+    if (cd "$dir" && "$1" > log 2>&1); then
+        echo "ok   $1"
+    else
+        echo "FAIL $1"
+        cat "$dir/log"
+        failures=$((failures + 1))
+    fi
+    rm -rf "$dir"
+}
+
+# A balanced plan with no facilities to select throws from step; the journal must still recover
+recoverFailedBalancedStep() {
+    printf 'settlement S 0\nplan S bal\n' > e.cfg
+    printf 'step 1\n' | "$BIN/simulation" e.cfg --journal e.jnl > /dev/null 2>&1
+    [ $? -eq 1 ] || return 1
+    printf 'planStatus 0\nclose\n' | "$BIN/simulation" --recover e.jnl > out 2>&1 || return 1
+    grep -q 'PlanID: 0' out
+}
+
+# The replay tool reports the same failure as an error, for a text recording and a journal
+replayFailedBalancedStep() {
+    printf 'settlement S 0\nplan S bal\n' > e.cfg
+    printf 'step 1\n' > e.cmd
+    "$BIN/replay" e.cmd --config e.cfg > out 2>&1
+    [ $? -eq 1 ] && grep -q 'Error: No facilities available.' out || return 1
+    "$BIN/simulation" e.cfg --journal e.jnl < e.cmd > /dev/null 2>&1
+    "$BIN/replay" e.jnl > out 2>&1 || return 1
+    grep -q 'Replayed 0 actions' out
+}
+
+# A long step jumps over the periods of each plan; it must end where single steps do
+longStepMatchesSingleSteps() {
+    printf 'settlement S 2\nfacility A 0 3 1 0 0\nfacility B 1 2 0 1 0\nfacility C 2 5 0 0 1\n' > f.cfg
+    printf 'plan S nve\nplan S bal\nplan S eco\nplan S env\n' >> f.cfg
+    { echo 'step 1000'; for plan in 0 1 2 3; do echo "planStatus $plan"; done; echo close; } > long.in
+    { for i in $(seq 1000); do echo 'step 1'; done; for plan in 0 1 2 3; do echo "planStatus $plan"; done; echo close; } > single.in
+    "$BIN/simulation" f.cfg < long.in > long.out || return 1
+    "$BIN/simulation" f.cfg < single.in > single.out || return 1
+    cmp long.out single.out
+}
+
+# Restoring the unnamed backup goes back to the checkpoint it was taken from, after a
+# recovery too, and a loaded simulation has no parent
+checkpointParents() {
+    printf 'settlement S 0\nfacility F 0 1 1 1 1\nplan S nve\n' > e.cfg
+    printf 'backup a\nstep 1\nbackup\nstep 1\nbackup b\nrestore\nbackup c\nsave x.snap\nload x.snap\nbackup d\nbackups\nclose\n' \
+        | "$BIN/simulation" e.cfg > out 2>&1 || return 1
+    grep -q '^c tick 1 parent a:' out && grep -q '^d tick 1 parent none:' out || return 1
+    # The load checkpoints the journal, so the recovery reads the backups back from its manifest
+    printf 'backup a\nstep 1\nbackup\nstep 1\nbackup b\nsave x.snap\nload x.snap\n' | "$BIN/simulation" e.cfg --journal e.jnl > /dev/null 2>&1 || return 1
+    printf 'restore\nbackup c\nbackups\nclose\n' | "$BIN/simulation" --recover e.jnl > out 2>&1 || return 1
+    grep -q '^c tick 1 parent a:' out
+}
+
+# A loaded snapshot has the log it was saved with, as records that print the same lines
+snapshotKeepsLog() {
+    printf 'settlement S 0\nfacility F 0 1 1 1 1\nplan S nve\n' > e.cfg
+    printf 'step 2\nbackup\nrestore\nchangePolicy 0 eco\nlog\nsave x.snap\nload x.snap\nlog\nclose\n' \
+        | "$BIN/simulation" e.cfg > out 2>&1 || return 1
+    sed -n '2,4p' out > before
+    sed -n '5,7p' out > after
+    [ -s before ] && cmp -s before after && grep -q '^changePolicy 0 eco .*COMPLETED' after
+}
+
+# Every CSV row has the columns of its header, whatever the number of facilities of a plan
+csvColumns() {
+    printf 'settlement S 0\nsettlement T 2\nfacility F 0 1 1 1 1\nfacility G,x 1 3 1 1 1\nplan S nve\nplan T eco\nplan S bal\n' > e.cfg
+    printf 'planStatus 0\nstep 3\nplanStatus 0\nplanStatus 1\nplanStatus 2\nclose\n' | "$BIN/simulation" e.cfg --report csv > out 2>&1 || return 1
+    grep -q '"G,x:OPERATIONAL;G,x:OPERATIONAL;G,x:OPERATIONAL"$' out || return 1
+    tail -n +2 out | awk -F, '{ gsub(/"[^"]*"/, "") } /^PlanID,/ { columns = NF; next } NF != columns { exit 1 }'
+}
+
+run recoverFailedBalancedStep
+run replayFailedBalancedStep
+run longStepMatchesSingleSteps
+run checkpointParents
+run snapshotKeepsLog
+run csvColumns
+
+echo "failures: $failures"
+[ $failures -eq 0 ]
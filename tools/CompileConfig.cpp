@@ -0,0 +1,28 @@
+#include "ConfigImage.h"
+#include "Simulation.h"
+#include <iostream>
+#include <stdexcept>
+
+/*
+Compiles a text config to a binary config image. The text is read by the same
+Simulation constructor as always, so the image holds exactly what it would have built.
+
+Usage: compile-config <config_path> <image_path>
+*/
+
+Simulation* backup = nullptr;
+
+int main(int argc, char** argv){
+    if(argc!=3){
+        std::cout << "usage: compile-config <config_path> <image_path>" << std::endl;
+        return 0;
+    }
+    try{
+        Simulation simulation(argv[1]);
+        ConfigImage::compile(simulation, argv[2]);
+    }catch(const std::runtime_error &e){
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "Auxiliary.h"
+#include "Journal.h"
+#include "OutputWriter.h"
+#include "Replay.h"
+#include "Simulation.h"
+#include "Snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+/*
+Replays a recorded session headlessly and reports how fast it ran. A text recording runs on
+the config or snapshot given with it; a journal runs from its own checkpoint. What the
+session prints is discarded, or written to the --output file. With --verify, the final plan
+scores are checked against the output the recorded session printed; the exit status is 1
+if they differ.
+
+Usage: replay <recording> [--config <config_path> | --resume <snapshot>] [--threads <count>]
+              [--output <path>] [--verify <recorded_output>]
+*/
+
+Simulation* backup = nullptr;
+
+int main(int argc, char** argv){
+    string recordingFile;
+    string configurationFile;
+    string snapshotFile;
+    string outputFile;
+    string recordedOutputFile;
+    int numOfThreads = 0;
+    bool validArguments = argc>=2;
+    for(int i=1; i<argc && validArguments; i++){
+        string argument = argv[i];
+        if(argument=="--threads" && i+1<argc){
+            i++;
+            Argument count = {argv[i], strlen(argv[i])};
+            validArguments = Auxiliary::parseInt(count, numOfThreads);
+        }
+        else if(argument=="--config" && i+1<argc){
+            configurationFile = argv[++i];
+        }
+        else if(argument=="--resume" && i+1<argc){
+            snapshotFile = argv[++i];
+        }
+        else if(argument=="--output" && i+1<argc){
+            outputFile = argv[++i];
+        }
+        else if(argument=="--verify" && i+1<argc){
+            recordedOutputFile = argv[++i];
+        }
+        else if(argument.compare(0, 2, "--")!=0 && recordingFile.empty()){
+            recordingFile = argument;
+        }
+        else{
+            validArguments = false;
+        }
+    }
+    const bool isJournal = validArguments && !recordingFile.empty() && Journal::isJournal(recordingFile);
+    const int numOfSources = !configurationFile.empty() + !snapshotFile.empty();
+    if(!validArguments || recordingFile.empty() || numOfSources!=(isJournal ? 0 : 1)){
+        std::cout << "usage: replay <recording> [--config <config_path> | --resume <snapshot>] [--threads <count>] [--output <path>] [--verify <recorded_output>]" << std::endl;
+        return 0;
+    }
+    try{
+        int descriptor = OutputWriter::DISCARD;
+        if(!outputFile.empty()){
+            descriptor = ::open(outputFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if(descriptor==-1){
+                throw std::runtime_error("Cannot open " + outputFile);
+            }
+        }
+        const int outputDescriptor = output.setDescriptor(descriptor);
+        const int errorsDescriptor = errors.setDescriptor(descriptor);
+        Replay::Result result;
+        Simulation simulation = isJournal ? Replay::replayJournal(recordingFile, numOfThreads, result)
+            : snapshotFile.empty() ? Simulation(configurationFile, numOfThreads) : Snapshot::load(snapshotFile);
+        if(!snapshotFile.empty()){
+            simulation.setNumOfThreads(numOfThreads);
+        }
+        if(!isJournal){
+            Replay::replayText(recordingFile, simulation, result);
+        }
+        output.setDescriptor(outputDescriptor);
+        errors.setDescriptor(errorsDescriptor);
+        if(descriptor!=OutputWriter::DISCARD){
+            ::close(descriptor);
+        }
+
+        char line[128];
+        std::snprintf(line, sizeof(line), "Replayed %zu actions in %.3f s: %.0f actions/sec",
+                      result.numOfActions, result.seconds, result.seconds > 0 ? result.numOfActions / result.seconds : 0.0);
+        std::cout << line << std::endl;
+        if(!recordedOutputFile.empty()){
+            const int numOfDifferences = Replay::verify(recordedOutputFile, simulation);
+            output.flush();
+            if(numOfDifferences!=0){
+                std::cout << "Verify failed: " << numOfDifferences << " plans differ from the recorded output" << std::endl;
+                return 1;
+            }
+            std::cout << "Verify passed" << std::endl;
+        }
+    }catch(const std::exception &e){
+        output.flush();
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}